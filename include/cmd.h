@@ -312,6 +312,8 @@ CmdFunc cmdFuncTable[] = {
 	{"readPipe",		CFNoLoad, 0,			1, -1,	NULL,		text809,	CFLit_readPipe},
 		// Returns name of buffer, or false if failure.
 	{"reframeWind",		0, 0,				0, 0,	NULL,		NULL,		CFLit_reframeWind},
+	{"reloadBuf",		0, 0,				0, 0,	reloadBuf,	NULL,		CFLit_reloadBuf},
+		// Returns true if buffer was updated, otherwise false.
 	{"renameBuf",		CFNoLoad, 0,			2, 2,	renameBuf,	text849,	CFLit_renameBuf},
 		// Returns name of new buffer.
 	{"renameFile",		CFNoLoad, 0,			2, 3,	renameFile,	text881,	CFLit_renameFile},
@@ -590,7 +590,24 @@ const char
  text495[] = "File",
  text496[] = "~bCurrent wrap col:~B %d, ~bprevious wrap col:~B %d",
  text497[] = "parameter name",
- text498[] = "previous";
+ text498[] = "previous",
+ text499[] = "\n%*s%sLines: %lu pooled, %lu free in %lu chunks (%luK), %lu oversize",
+ text500[] = ", cancelled",
+ text501[] = "Stopped following %s '%s': %s",
+ text502[] = "file was truncated or replaced",
+ text503[] = ", %s in %.3f sec",
+ text504[] = " (%s/sec)",
+ text505[] = "Recovered %u edit%s from journal \"%s\"",
+ text506[] = "Journal \"%s\" not applied: %s",
+ text507[] = "file was changed after journal was started",
+ text508[] = "journal is damaged",
+ text509[] = "Reload",
+ text510[] = "Reloaded file \"%s\" (%u change%s)",
+ text511[] = "File \"%s\" was changed outside of narrowed region",
+ text512[] = "corrupt compressed data",
+ text513[] = "Recover edits from journal \"%s\"",
+ text514[] = "compressed file",
+ text515[] = "Line too long (%ld bytes, maximum %d)";
 
 // General text literals.
 const char
@@ -770,7 +787,8 @@ Return name of command bound to given key-lit binding, or nil if none.\n\tValida
  times (default 1) and return string result, with ~binsert~B options."
 #define CFLit_bufAttrQ		"Check if given attribute is set in current buffer (or named buffer if optional bufname\
  argument given) and return Boolean result.  Attributes are: \n\tActive\t\tFile was read.\n\tChanged\t\tBuffer is\
- changed.\n\tCommand\t\tUser command buffer.\n\tFunction\tUser function buffer.\n\tHidden\t\tBuffer is hidden from\
+ changed.\n\tCommand\t\tUser command buffer.\n\tFollow\t\tText appended to file is added to buffer as it\
+ arrives.\n\tFunction\tUser function buffer.\n\tHidden\t\tBuffer is hidden from\
  view.\n\tNarrowed\tBuffer is in a narrowed state.\n\tReadOnly\tBuffer is read-only (may not be\
  modified).\n\tTermAttr\tTerminal attributes enabled in buffer."
 #define CFLit_bufBoundQ		"Return true if point at beginning (n < 0), middle (n == 0), end (n > 0), or either end\
@@ -791,7 +809,8 @@ Return name of command bound to given key-lit binding, or nil if none.\n\tValida
 #define CFLit_chgBufAttr	"Toggle, set, or clear all of the comma-separated attribute(s) specified in string argument\
  attrs in named buffer per n argument:\n\tn < 0\t\tClear attribute(s).\n\tn == 0\t\tToggle attribute(s) (default).\n\tn ==\
  1\t\tSet attribute(s).\n\tn > 1\t\tClear all, then set attribute(s).\nAttributes are:\n\tChanged\t\tBuffer is\
- changed.\n\tHidden\t\tBuffer is hidden from view.\n\tReadOnly\tBuffer is read-only (may not be\
+ changed.\n\tFollow\t\tText appended to buffer's file is added to end of buffer as it arrives (windows at end of buffer\
+ track it).\n\tHidden\t\tBuffer is hidden from view.\n\tReadOnly\tBuffer is read-only (may not be\
  modified).\n\tTermAttr\tTerminal attributes enabled in buffer.\nCase of attribute keywords is ignored.  If n > 1, attrs may\
  be nil, otherwise at least one attribute must be specified.  If interactive and default n, one attribute is toggled in current\
  buffer.\n\nReturns: former state (-1 or 1) of last attribute changed or zero if n > 1 and no attributes were specified.  (If\
@@ -1184,6 +1203,10 @@ All\t\tReturn all macros on macro ring in form [[name, value], ...]."
  Argument(s) are converted to string and concatenated to form the command.\n\nReturns: false if failure, otherwise\
  ~bselectBuf~B values."
 #define CFLit_reframeWind	"Reframe current window with point at [-]nth (n != 0) or center (n == 0, default) window line."
+#define CFLit_reloadBuf		"Update current buffer from its file if the file was changed since it was last read or saved,\
+ replacing only the lines that differ so that marks, window positions, and narrowing are kept.  If n argument, compare the file\
+ contents even if its size and modification time are unchanged.  User is prompted if the buffer was also changed. \
+ Returns: true if buffer was updated, otherwise false."
 #define CFLit_renameBuf		"Rename buffer \"old\" to \"new\" (or if interactive and default n, rename current buffer). \
  Returns: new buffer name."
 #define CFLit_renameFile	"Rename a file on disk.  If n argument, one or both of the following comma-separated option(s)\
@@ -1308,6 +1331,7 @@ Case of parameter names is ignored."
 \tZero or more of the following options may also be specified:\n\
 \t\tHidden\t\tInclude hidden (non-command/function) buffers in selection.\n\
 \t\tHomeDir\t\tInclude buffer's home directory in display if available.\n\
+\t\tMemory\t\tInclude buffer's line storage statistics in display.\n\
 The first column in the list is buffer attribute and state information:\
  ~u~bA~Zctive, ~u~bH~Zidden, ~u~bU~Zser command/function, ~u~bP~Zreprocessed, ~u~bN~Zarrowed, ~u~bT~ZermAttr, ~u~bB~Zackground,\
  ~u~bR~ZeadOnly, and ~u~bC~Zhanged.\n\nReturns: ~bselectBuf~B values."
@@ -1524,6 +1548,8 @@ element delimiter may also be specified in optional string argument dlm (and opt
 #define MLit_Fence1		"Show matching ( ), [ ], or { } fence when typing."
 #define MLit_Fence2		"Show matching ( ), [ ], { }, or < > fence when typing."
 #define MLit_HorzScroll		"Horizontally scroll all window lines simultaneously."
+#define MLit_Journal		"Record edits in journal (" JournalExt ") files for crash recovery instead of saving files at auto-save\
+ time."
 #define MLit_LineDisp		"Display line number of point on mode line."
 #define MLit_Overwrite		"Overwrite columns when typing."
 #define MLit_ReadOnly		"Open all files in read-only mode."
@@ -1531,6 +1557,7 @@ element delimiter may also be specified in optional string argument dlm (and opt
 #define MLit_Replace		"Replace characters when typing."
 #define MLit_RtnMsg		"Save and display return messages."
 #define MLit_SafeSave		"Safe file save (write temporary file first)."
+#define MLit_SyncSave		"Durable file save (flush temporary file to disk, then rename it over original)."
 #define MLit_WorkDir		"Display working directory on bottom mode line if room."
 #define MLit_Wrap		"Automatic word wrap."
 
@@ -1586,6 +1613,8 @@ element delimiter may also be specified in optional string argument dlm (and opt
 #define VLit_autoSave		"Keystroke count that triggers auto-save.  Feature is disabled if value is zero."
 #define VLit_bufFile		"Filename associated with current buffer."
 #define VLit_bufLineNum		"Ordinal number of line containing point in current buffer."
+#define VLit_bufMemLimit	"Memory budget in kilobytes for buffer text (or unlimited if zero).  When exceeded, the text of\
+ unchanged, undisplayed file buffers is dropped (least recently used first) and re-read when next used."
 #define VLit_bufname		"Name of current buffer."
 #define VLit_execPath		"Colon-separated list of script search directories.  If a directory is null, the current\
  directory is searched."
@@ -1671,7 +1700,9 @@ extern const char
  text460[], text461[], text462[], text463[], text464[], text465[], text466[], text467[], text468[], text469[], text470[],
  text471[], text472[], text473[], text474[], text475[], text476[], text477[], text478[], text479[], text480[], text481[],
  text482[], text483[], text484[], text485[], text486[], text487[], text488[], text489[], text490[], text491[], text492[],
- text493[], text494[], text495[], text496[], text497[],	text498[];
+ text493[], text494[], text495[], text496[], text497[],	text498[], text499[], text500[],
+ text501[], text502[], text503[], text504[], text505[], text506[], text507[], text508[],
+ text509[], text510[], text511[], text512[], text513[], text514[], text515[];
 extern const char
  text803[];
 #if MMDebug & Debug_ShowRE
@@ -9,6 +9,7 @@
 #define IOS_OtpFile	0x0001		// Writing to a file.
 #define IOS_NoDelim	0x0002		// No delimiter at EOF.
 #define IOS_RSHigh	0x0004		// Set RSHigh flag in return message.
+#define IOS_Rate	0x0008		// Report output size and throughput.
 
 // Flags for selected buffer and file operations, used by opConfirm() and setFilename() functions.
 #define BF_UpdBufDir	0x0001		// Update buffer directory.
@@ -22,16 +23,38 @@
 #define FTypDir		0x0004		// Directory.
 #define FTypOther	0x0008		// Other file type.
 
+// Safe save flags in SaveJob object.
+#define SVSafe		0x0001		// Write temporary file and rename it over target file ('Safe' mode).
+#define SVBak		0x0002		// Rename target file to backup file first ('Bak' mode).
+#define SVSync		0x0004		// Flush temporary file to disk before renaming it via f_syncSave() ('Sync' mode).
+
 // File information.  Any given file is opened, processed, and closed before the next file is dealt with; therefore, the file
 // handle (and control variables) can be shared among all files and I/O functions.  Note however, that userInpDelim and
 // userOtpDelim are permanent and maintained by the user.
 #define FIEOF		0x0001		// Hit EOF on input.
 #define FIRetry		0x0002		// Read from or write to a pipe with retries.
+#define FIDurable	0x0004		// Output file is being saved durably (via f_syncSave()).
+#define FICompress	0x0008		// Output file is written gzip-compressed.
 
 #define FIFileBufSize	32768		// Size of file input buffer.
 #define FILineBufSize	256		// Initial size of line input buffer.
+#define FIZBlocks	4		// Number of decompressed blocks queued ahead of line scanning for compressed input.
+#define FIZLevel	6		// Compression level for output files.
+#define FIOtpVecMax	1024		// Maximum number of vector entries gathered for one writev() call on output.
+#define FIOtpCopyMax	512		// Strings at least this long are written in place instead of copied into I/O buffer.
 #define FIPipeDelay	3		// Initial number of centiseconds to pause between I/O attempts (via a pipe).
 #define FIPipeAttempts	5		// Number of I/O attempts (via a pipe) before giving up.
+#define FIParLoadMin	4194304		// Minimum amount of mapped input remaining for lines to be loaded in parallel.
+#define FIParLoadMax	16		// Maximum number of threads used to load lines in parallel.
+#define FIParLoadRound	67108864	// Maximum amount of input loaded in parallel between progress updates.
+#define FIParSaveMax	8		// Maximum number of threads used to write buffers in parallel when saving all.
+#define FIProgressLines	16384		// Number of lines read between progress updates (interactive only).
+#define FIFollowPoll	1000		// Milliseconds between checks of followed files while waiting for a keystroke.
+#define FIJrnlMagic	"#MightEMacs journal 1"	// First line of a journal file (followed by base file size and time).
+#define FIJrnlCompact	1048576		// Minimum size of a journal file before it is compacted.
+#define FIHashBasis	((ulong) 14695981039346656037ULL)	// FNV-1a offset basis for file text hashes.
+#define FIHashPrime	((ulong) 1099511628211ULL)		// FNV-1a prime for file text hashes.
+#define FIDiffMax	1000		// Maximum number of line edits found by reloadBuf() before it replaces a whole range.
 
 typedef struct {
 	const char *filename;		// Filename passed to f_ropen() or f_wopen().
@@ -45,9 +68,94 @@ typedef struct {
 	char *lineBuf;			// Pointer to input line buffer (on heap).
 	char *lineBufCur, *lineBufEnd;	// Line buffer pointers.
 	char dataBuf[FIFileBufSize];	// Bulk I/O buffer.
-	char *ioBufCur, *ioBufEnd;	// Bulk I/O buffer pointers.
+	char *ioBufCur, *ioBufEnd;	// Bulk I/O buffer pointers (into dataBuf, or into mapBase if input file is mapped).
+	char *mapBase;			// Memory-mapped input file, or NULL if none.
+	size_t mapSize;			// Size of mapped region.
+	size_t mapPageSize;		// System page size, for SIGBUS handler.
+	off_t inpOffset;		// Input file offset of end of data in I/O buffer.
+	struct Inflater *pInflater;	// Decompression state if input file is compressed, otherwise NULL.
 	} FileInfo;
 
+// Work unit for loading a range of lines from a mapped input file in a separate thread.  The range begins at the beginning
+// of a line and (except for the last one) ends after a delimiter.  Lines are carved from a private line pool and linked into
+// a detached list, which is spliced into the target buffer after all threads have finished.
+typedef struct {
+	const char *start, *end;	// Byte range to process.
+	const char *stop;		// Returned position following last delimiter found.
+	LinePool linePool;		// Private line pool.
+	Line *pFirstLine, *pLastLine;	// Returned line list, or NULL if none.
+	long lineCt, byteCt;		// Returned line and byte counts.
+	bool outOfMem;			// Returned "out of memory" flag.
+	} LoadJob;
+
+// Work unit for saving a buffer.  When all buffers are saved, the write hook is run and the output file is opened in the main
+// thread, the buffer is written and the file closed in a worker thread, and the save is completed (and reported) in the main
+// thread again, in the original buffer order.
+typedef struct {
+	Buffer *pBuf;			// Buffer to save.
+	const char *filename;		// Target file (absolute pathname if not in current directory).
+	Datum *pTempName;		// Temporary file, if safe save.
+	Datum *pBakName;		// Backup file, if 'bak' save.
+	ushort saveFlags;		// Safe save flags (SVxxx).
+	bool bufFile;			// Target is buffer's own file.
+	bool compress;			// Write file gzip-compressed.
+	int fileHandle;			// Open output file.
+	LineDelim otpDelim;		// Output line delimiter(s).
+	bool addNL;			// Add delimiter after last line.
+	uint lineCt;			// Returned line count.
+	off_t count;			// Returned byte count.
+	double time;			// Returned elapsed time of write in seconds.
+	int errNum;			// Returned error number of failed write or close, or zero if none.
+	} SaveJob;
+
+// Control object for saveBufs().
+typedef struct {
+	SaveJob *jobs;			// Pending saves written in parallel (on heap), or NULL if saving one buffer.
+	uint jobCt, jobMax;		// Number of pending saves and size of jobs array.
+	uint nextJob;			// Next pending save to be claimed by a worker thread.
+	uint savedCount;		// Count of saved buffers.
+	uint narCount;			// Count of narrowed buffers that are skipped.
+	} SaveCtrl;
+
+// Follow-mode state of a buffer.  The file is identified by device and inode number so that rotation (replacement of the
+// file by a new one of the same name) can be detected.
+typedef struct Follow {
+	char *pathname;			// Absolute pathname of file (on heap).
+	int watch;			// inotify watch descriptor, or -1 if none.
+	off_t pos;			// File offset of first byte not yet added to buffer.
+	dev_t dev;			// Device number of file.
+	ino_t ino;			// Inode number of file.
+	} Follow;
+
+// Edit journal of a changed buffer ("Journal" mode).  The primitive edits made to the buffer (insertions and deletions at a
+// line number and offset) are recorded in memory and appended to the journal file at auto-save time, so that they can be
+// replayed over the buffer's file after a crash.  If a change cannot be recorded or the file grows larger than the buffer, the
+// file is rewritten with a snapshot of the buffer text instead.  The file is deleted when the buffer is saved.
+typedef struct Journal {
+	char *pathname;			// Absolute pathname of journal file (on heap).
+	off_t baseSize;			// Size of buffer's file when journal was started, or -1 if file did not exist.
+	time_t baseTime;		// Modification time of buffer's file when journal was started.
+	off_t fileSize;			// Size of journal file, or -1 if not written yet.
+	char *buf;			// Pending records (on heap).
+	size_t used, size;		// Bytes used and allocated in buf.
+	bool armed;			// Edit was just recorded, so next change is accounted for.
+	bool snapshot;			// Unrecorded change was made: rewrite file with snapshot of buffer.
+	} Journal;
+
+// Pending durable save: a temporary file holding the new contents of a file, which is flushed to disk and renamed over the
+// target file by f_syncAll().  Filenames are relative to the directory open on dirFD.
+typedef struct {
+	Buffer *pBuf;			// Buffer that was saved, or NULL if file could not be replaced.
+	bool bufFile;			// Buffer was saved to its own file.
+	bool dirSynced;			// Directory was synced after file was replaced.
+	int dirFD;			// File descriptor of directory containing files.
+	dev_t dirDev;			// Device and inode numbers of directory, for syncing each directory once.
+	ino_t dirIno;
+	char *tempName;			// Temporary file (on heap, with filename and bakName).
+	char *filename;			// Target file.
+	char *bakName;			// Backup file to link to target before replacement, or NULL if none.
+	} SyncSave;
+
 // Data-insertion object used by insertData() function.
 typedef struct {
 	Buffer *pTargBuf;		// Target buffer.
@@ -66,6 +174,9 @@ extern char *fbasename(const char *name, bool withExt);
 extern char *fdirname(char *name, int n);
 extern uint fileExists(const char *filename);
 extern int findViewFile(Datum *pRtnVal, int n, bool view);
+extern int followBuf(Buffer *pBuf);
+extern void followEnd(Buffer *pBuf);
+extern int followWait(void);
 extern int getFilename(Datum *pRtnVal, const char *prompt, const char *def, uint flags);
 extern int getPath(char *filename, bool resolve, Datum *pPath);
 extern int globPat(Datum *pRtnVal, int n, Datum **args);
@@ -75,12 +186,17 @@ extern int insertFile(Datum *pRtnVal, int n, Datum **args);
 extern int insertLine(const char *src, int len, bool hasDelim, Buffer *pBuf, Point *pPoint);
 extern int ioStat(DFab *rtnMsg, ushort flags, Datum *pBakName, int status, const char *filename, const char *action,
  uint lineCt);
+extern void journalChange(Buffer *pBuf);
+extern int journalEdit(short type, Point *pPoint, long len, const char *str, short c);
+extern void journalEnd(Buffer *pBuf, bool remove);
+extern int journalFlush(void);
 extern int linkFile(Datum *pRtnVal, int n, Datum **args);
 extern bool opConfirm(ushort flags);
 extern void otpInit(Buffer *pBuf, int fileHandle);
 extern int readFile(Datum *pRtnVal, int n, Datum **args);
 extern int readIn(Buffer *pBuf, const char *filename, ushort flags);
 extern int readPrep(Buffer *pBuf, ushort flags);
+extern int reloadBuf(Datum *pRtnVal, int n, Datum **args);
 #if USG
 extern int rename(const char *file1, const char *file2);
 #endif
@@ -96,7 +212,7 @@ extern int xPathname(Datum *pRtnVal, int n, Datum **args);
 
 // Global variables.
 FileInfo fileInfo = {			// File I/O information.
-	NULL, -1, -1, false, {"", 0}, -1, -1, {"", 0}, {"", 0}, NULL, NULL, NULL, "", NULL, NULL
+	NULL, -1, -1, false, {"", 0}, -1, -1, {"", 0}, {"", 0}, NULL, NULL, NULL, "", NULL, NULL, NULL, 0, 0, 0, NULL
 	};
 #else
 
@@ -10,6 +10,8 @@
 
 #define CharScanCount	50000000	// Number of scanned regexp characters which triggers display of progress message.
 #define Metacharacters	"^$([{.*+?|\\"	// Metacharacters in a regular expression.
+#define RELitMax	32		// Maximum length of literal extracted from RE pattern for line prefilter.
+#define PatCacheMax	16		// Maximum number of unused compiled patterns kept in pattern cache.
 
 // Metacharacters.
 #define MC_Any		'.'		// 'Any' character (except newline).
@@ -93,6 +95,26 @@ typedef struct {
 	regex_t compBackPat;		// Compiled backward (reversed) pattern.
 	} RegPat;
 
+// Pattern cache entry, which holds the compiled forms of a search pattern so that they can be reused when the same pattern
+// is searched for again.  Entries are kept in a list in most-recently-used order, and Match and BufSearch objects refer to
+// the entry their compiled patterns were copied from.
+typedef struct PatCache {
+	struct PatCache *prev, *next;	// Previous and next entries in list.
+	char *pat;			// Pattern.
+	int patLen;			// Length of pattern.
+	bool plain;			// Plain text (Boyer-Moore) pattern, otherwise RE?
+	int compFlags;			// Compilation flags.
+	ushort flags;			// SCpl_xxx flags for patterns compiled so far.
+	uint useCount;			// Number of objects using entry (which may not be evicted if not zero).
+	union {
+		RegPat regPat;		// Compiled RE patterns.
+		struct {
+			BMPat forwBM;	// Compiled forward Boyer-Moore pattern.
+			BMPat backBM;	// Compiled backward Boyer-Moore pattern.
+			} bm;
+		} u;
+	} PatCache;
+
 // Meta-character structure for a replacment pattern element.
 typedef struct ReplPat {
 	struct ReplPat *next;
@@ -118,6 +140,7 @@ typedef struct {
 	int patLen;			// Length of search pattern (RE and non-RE) without trailing option characters.
 	char *pat;			// Forward search pattern (RE and non-RE) without trailing option characters.
 	RegPat regPat;			// Compiled RE search patterns (forward and backward).
+	PatCache *pCache;		// Pattern cache entry "regPat" was copied from, or NULL if none.
 	char *replPat;			// Replacement pattern (RE and non-RE).
 	ReplPat *compReplPat;		// Compiled RE replacement pattern.
 	GrpMatch grpMatch;		// Datum objects for each RE group string found in search.  Group 0 contains
@@ -132,7 +155,11 @@ typedef struct {
 #endif
 	BMPat forwBM;			// Forward Boyer-Moore (non-RE) compilation object.
 	BMPat backBM;			// Backward Boyer-Moore (non-RE) compilation object.
+	PatCache *pBMCache;		// Pattern cache entry "forwBM" and "backBM" were copied from, or NULL if none.
 	Match match;			// Match information.
+	bool reLineLocal;		// RE pattern cannot match a newline (so regScan() may scan one line at a time).
+	char reLit[RELitMax];		// Literal that every match of RE pattern must contain (for regScan() line prefilter).
+	int reLitLen;			// Length of literal, or zero if none or pattern is not line-local.
 	} BufSearch;
 
 // Flags in Match structure.
@@ -48,6 +48,7 @@
 #define Debug_NCurses	0x00400000	// Debug ncurses routines.
 #define Debug_SrchRepl	0x00800000	// Debug search and replace routines.
 #define Debug_Regexp	0x01000000	// Debug regular expressions.
+#define Debug_BufTotals	0x02000000	// Verify buffer line and byte totals in bufLength().
 #define Debug_Temp	0x80000000	// For ad-hoc use.
 
 #define MMDebug		0		// No debugging code.
@@ -97,6 +98,8 @@
 #define WordCount	0		// Include code for "countWords" command (deprecated).
 #define MacroDelims	",|;"		// Macro encoding delimiters, in order of preference.
 #define BackupExt	".bak"		// Backup file extension.
+#define JournalExt	".jrnl"		// Edit journal file extension.
+#define GzipExt		".gz"		// Extension of files written gzip-compressed.
 #define ScriptExt	".ms"		// Script file extension.
 #define UserStartup	".memacs"	// User start-up file (in HOME directory).
 #define SiteStartup	"memacs.ms"	// Site start-up file.
@@ -107,6 +110,11 @@
 
 // Limits -- [Set any].
 #define LineBlockSize	32		// Number of bytes, line block chunks.
+#define LinePoolClasses	32		// Number of line pool size classes (in LineBlockSize increments).
+#define LinePoolChunk	131072		// Maximum size of a line pool memory chunk in bytes.
+#define LinePoolChunkMin 4096		// Size of first line pool memory chunk (doubled for each one after, up to LinePoolChunk).
+#define LongLineSize	4096		// Line length at which line storage begins to grow geometrically.
+#define LineIdxBlkSize	128		// Number of lines in a line index block when index is built (split at twice this).
 #define MacroRingSize	 0		// Default number of entries in macro ring.
 #define KillRingSize	50		// Default number of entries in kill ring.
 #define DelRingSize	30		// Default number of entries in delete ring.
@@ -200,6 +208,7 @@
 #define OpNoLoad	0x0200		// Do not load function arguments (non-command-line hook is running).
 #define OpScrnRedraw	0x0400		// Clear and redraw screen (in update() function).
 #define OpUserCmd	0x0800		// User command being executed (interactive mode).
+#define OpEvict		0x1000		// Enforce buffer memory budget before next command (in editLoop() function).
 
 // Terminal attribute characters.
 #define AttrSpecBegin	'~'		// First character of a terminal attribute sequence.
@@ -479,16 +488,18 @@ typedef struct {
 #define MdIdxFence1	6
 #define MdIdxFence2	7
 #define MdIdxHScrl	8
-#define MdIdxLine	9
-#define MdIdxOver	10
-#define MdIdxReadOnly	11
-#define MdIdxRegexp	12
-#define MdIdxRepl	13
-#define MdIdxRtnMsg	14
-#define MdIdxSafe	15
-#define MdIdxWkDir	16
-#define MdIdxWrap	17
-#define NumModes	18		// Length of mode cache array.
+#define MdIdxJournal	9
+#define MdIdxLine	10
+#define MdIdxOver	11
+#define MdIdxReadOnly	12
+#define MdIdxRegexp	13
+#define MdIdxRepl	14
+#define MdIdxRtnMsg	15
+#define MdIdxSafe	16
+#define MdIdxSync	17
+#define MdIdxWkDir	18
+#define MdIdxWrap	19
+#define NumModes	20		// Length of mode cache array.
 
 // Mode information.
 typedef struct {
@@ -526,6 +537,7 @@ typedef struct {
 // expensive to run for every input character.
 typedef struct EWindow {
 	struct EWindow *next;		// Next window.
+	struct EWindow *pNextBufWind;	// Next window (on any screen) displaying the same buffer.
 	struct Buffer *pBuf;		// Buffer displayed in window.
 	Face face;			// Point position, etc.
 	ushort id;			// Unique window identifier (mark used to save face before it's buffer is narrowed).
@@ -599,11 +611,24 @@ typedef struct {
 // Buffer mark and flags.
 typedef struct Mark {
 	struct Mark *next;		// Next mark.
+	struct Mark *pNextLineMark;	// Next mark in same mark registry slot.
 	ushort id;			// Mark identifier.
 	short reframeRow;		// Target (reframe) row in window for point.
 	Point point;			// Point position.
 	} Mark;
 
+// Mark registry, which maps Line pointers to the marks on them so that edit fix-ups only need to visit the marks on the lines
+// being changed.  It is a hash table of mark chains (linked via pNextLineMark) which is rebuilt on demand after it is
+// invalidated by any operation that creates, deletes, or moves a mark to a different line.  The marks in a chain are not
+// guaranteed to all be on the same line, so callers must check.
+typedef struct {
+	Mark **table;			// Hash table of mark chains.
+	uint size;			// Size of table (a power of two), or zero if none.
+	bool valid;			// Registry is current.
+	} MarkReg;
+
+#define mregclear(pBuf)	((pBuf)->markReg.valid = false)
+
 #define MKAutoR		0x0001		// Use mark RegionMark if default n; otherwise, prompt with no default (setMark).
 #define MKAutoW		0x0002		// Use mark WorkMark if default n; otherwise, prompt with no default (markBuf).
 #define MKHard		0x0004		// Always prompt, no default (delMark, gotoMark, swapMark).
@@ -629,6 +654,51 @@ typedef struct BufMode {
 	ModeSpec *pModeSpec;		// Pointer to (enabled) mode in mode table.
 	} BufMode;
 
+// Line objects for a buffer are suballocated from a line pool kept in the Buffer object.  Lines with a text size of
+// LinePoolMax bytes or less are carved from memory chunks in size classes of LineBlockSize bytes and are recycled via a
+// free list for each class (linked by the "next" member) when released; longer (oversize) lines are allocated individually.
+// This keeps per-line malloc overhead down and allows all pooled lines in a buffer to be freed in one step when it is cleared.
+// Lines read from a file or buffer are "packed" instead: carved back to back at their exact size (see lpalloc()), and replaced
+// with a size-class line the first time they grow.  Released packed lines too small for the smallest size class are kept on
+// "small" free lists (by size, in pointer-size increments) and reused for short lines.
+#define LinePoolMax	(LinePoolClasses * LineBlockSize)
+#define LinePoolSmall	(LineBlockSize / sizeof(void *))
+
+typedef struct LineChunk {
+	struct LineChunk *next;		// Next chunk in list.
+	char *avail;			// Beginning of unused space in chunk.
+	char *end;			// End of chunk.
+	} LineChunk;
+
+typedef struct {
+	LineChunk *chunkHead;		// Memory chunks, most recent first.
+	struct Line *freeList[LinePoolClasses];// Released lines, by size class.
+	struct Line *smallList[LinePoolSmall];// Released packed lines smaller than LineBlockSize, by size.
+	ulong chunkCount;		// Number of chunks allocated.
+	ulong chunkBytes;		// Total size of chunks in bytes.
+	ulong lineCount;		// Number of pooled lines in use.
+	ulong freeCount;		// Number of pooled lines on free lists.
+	ulong bigCount;			// Number of oversize lines in use.
+	} LinePool;
+
+// A positional index may be kept for the lines in a buffer so that line numbers can be mapped to Line pointers and vice versa
+// in logarithmic time.  The visible lines are partitioned into consecutive blocks, each line points to the block it belongs to,
+// and a Fenwick (binary indexed) tree of the block line counts gives the number of lines preceding any block.  The index is
+// built on demand, kept current by the line-linking routines (llink(), lunlink(), lreplace1(), etc.), and simply discarded by
+// operations that rearrange lines wholesale (narrowing, sorting, clearing) to be rebuilt by the next lookup.
+typedef struct LineBlk {
+	struct Line *pFirstLine;	// First line in block.
+	int lineCount;			// Number of lines in block.
+	int index;			// Position of block in index.
+	} LineBlk;
+
+typedef struct {
+	LineBlk **blocks;		// Blocks in buffer order, or NULL if index does not exist.
+	long *tree;			// Fenwick tree of block line counts (1-origin).
+	int blockCount;			// Number of blocks in use.
+	int blockMax;			// Allocated size of "blocks" array.
+	} LineIndex;
+
 // Text is kept in buffers.  A buffer header, described below, exists for every buffer in the system.  Buffers are kept in a
 // array sorted by buffer name to provide quick access to the next or previous buffer, to allow for quick binary searching by
 // name, and to eliminate the need to sort the list when doing buffer completions and creating the "showBuffers" listing.  There
@@ -646,7 +716,23 @@ typedef struct Buffer {
 	struct Line *pFirstLine;	// Pointer to first line.
 	struct Line *pNarTopLine;	// Pointer to narrowed top text.
 	struct Line *pNarBotLine;	// Pointer to narrowed bottom text.
+	LinePool linePool;		// Line storage.
+	LineIndex lineIdx;		// Line number index.
+	long lineTotal;			// Number of Line objects in buffer (or narrowed region).
+	long byteTotal;			// Sum of line lengths in buffer (or narrowed region), excluding newlines.
+	long narLineTotal;		// Number of Line objects in narrowed top and bottom fragments.
+	long narByteTotal;		// Sum of line lengths in narrowed top and bottom fragments.
+	EWindow *pWindHead;		// Windows displaying buffer (window registry), linked via pNextBufWind.
 	Mark markHdr;			// Mark list header.
+	MarkReg markReg;		// Mark registry.
+	long *evictPos;			// Saved line numbers of face and marks if text was evicted (on heap), otherwise NULL.
+	ulong lastUse;			// Session use-clock value at last activation, for eviction in LRU order.
+	struct Follow *pFollow;		// Follow-mode state if file is being followed (on heap), otherwise NULL.
+	off_t readSize;			// Number of bytes of file consumed by last read.
+	off_t statSize;			// Size of file at last read or save, or -1 if unknown.
+	time_t statTime;		// Modification time of file at last read or save.
+	ulong textHash;			// Hash of file text at last read or save.
+	struct Journal *pJrnl;		// Edit journal if buffer is being journaled (on heap), otherwise NULL.
 	CallInfo *pCallInfo;		// Pointer to user command/function parameters, if applicable.
 	const char *saveDir;		// Buffer's "home" directory (absolute pathname in directory table).
 	ushort windCount;		// Count of windows displaying buffer.
@@ -672,6 +758,7 @@ typedef struct Buffer {
 #define BFQSave		0x0080		// Buffer was saved via quickExit().
 #define BFReadOnly	0x0100		// Buffer is read only.
 #define BFTermAttr	0x0200		// Terminal attributes enabled.
+#define BFFollow	0x0400		// Text appended to file is added to buffer as it arrives.
 
 #define BFCmdFunc	(BFCommand | BFFunc)
 #define BCmdFuncLead	'@'		// Leading character of script buffer.
@@ -761,6 +848,7 @@ typedef struct {
 typedef struct Line {
 	struct Line *next;		// Pointer to the next line.
 	struct Line *prev;		// Pointer to the previous line.
+	struct LineBlk *pBlk;		// Line index block (valid only if buffer's line index exists).
 	int size;			// Allocated size.
 	int used;			// Used size.
 	char text[1];			// A bunch of characters.
@@ -907,12 +995,13 @@ typedef enum {
 	cf_openLine, cf_openLineI, cf_ord, cf_outdentRegion, cf_overwriteChar, cf_overwriteCol, cf_pathname, cf_pause,
 	cf_pipeBuf, cf_popBuf, cf_popFile, cf_prefix1, cf_prefix2, cf_prefix3, cf_prevBuf, cf_prevScreen, cf_prevWind, cf_print,
 	cf_printf, cf_prompt, cf_queryReplace, cf_quickExit, cf_quote, cf_quoteChar, cf_rand, cf_readFile, cf_readPipe,
-	cf_reframeWind, cf_renameBuf, cf_renameFile, cf_renameMacro, cf_replace, cf_resetTerm, cf_resizeWind, cf_restoreBuf,
-	cf_restoreScreen, cf_restoreWind, cf_revertYank, cf_ringSize, cf_run, cf_saveBuf, cf_saveFile, cf_saveScreen,
-	cf_saveWind, cf_scratchBuf, cf_searchBack, cf_searchForw, cf_selectBuf, cf_selectLine, cf_selectScreen, cf_selectWind,
-	cf_setBufFile, cf_setColorPair, cf_setDefault, cf_setDispColor, cf_setHook, cf_setMark, cf_setWrapCol, cf_seti,
-	cf_shQuote, cf_shell, cf_shellCmd, cf_showAliases, cf_showBuffers, cf_showColors, cf_showCommands, cf_showDir,
-	cf_showFence, cf_showFunctions, cf_showHooks, cf_showKey, cf_showMarks, cf_showModes, cf_showPoint,
+	cf_reframeWind, cf_reloadBuf, cf_renameBuf, cf_renameFile, cf_renameMacro, cf_replace, cf_resetTerm, cf_resizeWind,
+	cf_restoreBuf, cf_restoreScreen, cf_restoreWind, cf_revertYank, cf_ringSize, cf_run, cf_saveBuf, cf_saveFile,
+	cf_saveScreen, cf_saveWind, cf_scratchBuf, cf_searchBack, cf_searchForw, cf_selectBuf, cf_selectLine,
+	cf_selectScreen, cf_selectWind, cf_setBufFile, cf_setColorPair, cf_setDefault, cf_setDispColor, cf_setHook,
+	cf_setMark, cf_setWrapCol, cf_seti, cf_shQuote, cf_shell, cf_shellCmd, cf_showAliases, cf_showBuffers,
+	cf_showColors, cf_showCommands, cf_showDir, cf_showFence, cf_showFunctions, cf_showHooks, cf_showKey, cf_showMarks,
+	cf_showModes, cf_showPoint,
 #if MMDebug & Debug_ShowRE
 	cf_showRegexp,
 #endif
@@ -1048,6 +1137,8 @@ typedef struct {
 	int exitNArg;			// n argument given for "exit" or "quickExit" command.
 	RtnStatus rtn;			// Current return parameters from a command or function.
 	RtnStatus scriptRtn;		// Return parameters from a script (for $ReturnMsg).
+	long bufMemLimit;		// Memory budget for buffer text in kilobytes ($bufMemLimit), or zero if unlimited.
+	ulong useClock;			// Buffer use clock (for LRU eviction).
 	} SessionCtrl;
 
 // Column-header widths, used by rptHdr().
@@ -1071,6 +1162,7 @@ extern int backLine(Datum *pRtnVal, int n, Datum **args);
 extern int backPage(Datum *pRtnVal, int n, Datum **args);
 extern int backWord(Datum *pRtnVal, int n, Datum **args);
 extern int bactivate(Buffer *pBuf);
+extern int bevict(void);
 extern int bappend(Buffer *pBuf, const char *text);
 extern void bchange(Buffer *pBuf, ushort flags);
 extern int bclear(Buffer *pBuf, ushort flags);
@@ -1151,6 +1243,7 @@ extern int edInsertTab(int n);
 extern int editAlias(const char *name, ushort op, UnivPtr *pUniv);
 extern int editMode(Datum *pRtnVal, int n, Datum **args);
 extern int editModeGroup(Datum *pRtnVal, int n, Datum **args);
+extern int einsertBlk(const char *str, int len, bool literalNL);
 extern int einsertc(int n, short c);
 extern int einserts(const char *str);
 extern int einsertNL(void);
@@ -1172,7 +1265,6 @@ extern int fIndex(Datum *pRtnVal, int n, Datum **args);
 extern Ring *findRing(Datum *pName);
 extern EWindow *findWind(Buffer *pBuf, EScreen **ppScrn);
 extern void fixBufFace(Buffer *pBuf, int offset, int n, Line *pLine1, Line *pLine2);
-extern void fixFace(int offset, int n, Line *pLine1, Line *pLine2);
 extern int forwChar(Datum *pRtnVal, int n, Datum **args);
 extern int forwLine(Datum *pRtnVal, int n, Datum **args);
 extern int forwPage(Datum *pRtnVal, int n, Datum **args);
@@ -1184,6 +1276,7 @@ extern int getCF(const char *prompt, UnivPtr *pUniv, uint selector);
 extern uint getFlagOpts(Option *pOpt);
 extern int getInfo(Datum *pRtnVal, int n, Datum **args);
 extern long getLineNum(Buffer *pBuf, Line *pTargLine);
+extern Line *getLinePtr(Buffer *pBuf, long lineNum);
 extern int getLineRegion(int n, Region *pRegion, ushort flags);
 extern int getModes(Datum *pRtnVal, Buffer *pBuf);
 extern int getNArg(Datum *pRtnVal, const char *prompt);
@@ -1207,7 +1300,7 @@ extern bool haveColor(void);
 extern int help(Datum *pRtnVal, int n, Datum **args);
 extern const char *hookFuncName(UnivPtr *pUniv);
 extern int indentRegion(Datum *pRtnVal, int n, Datum **args);
-extern char *inflate(char *dest, const char *src, bool plural);
+extern char *inflateStr(char *dest, const char *src, bool plural);
 extern void initBoolOpts(Option *pOpt);
 extern void initCharTables(void);
 extern void initInfoColors(void);
@@ -1233,13 +1326,23 @@ extern int kdcForwWord(int n, int kdc);
 extern int kdcLine(int n, int kdc);
 extern int kdcText(int n, int kdc, Region *pRegion);
 extern int killPrep(int kill);
-extern int lalloc(int used, Line **ppLine);
+extern int lalloc(int used, Buffer *pBuf, Line **ppLine);
 extern int libfail(void);
 extern int libfatal(void);
 extern void llink(Line *pLine1, Buffer *pBuf, Line *pLine2);
 extern bool lineInWind(EWindow *pWind, Line *pLine);
+extern Mark *lineMarks(Buffer *pBuf, Line *pLine);
+extern int lpalloc(int used, Buffer *pBuf, Line **ppLine);
+extern void lpfree(LinePool *pPool);
+extern void lpinit(LinePool *pPool);
+extern void lpmerge(LinePool *pDestPool, LinePool *pSrcPool);
+extern Line *lpnew(LinePool *pPool, const char *text, int used);
+extern void lrelease(Line *pLine, Buffer *pBuf);
 extern void lreplace1(Line *pLine1, Buffer *pBuf, Line *pLine2);
+extern void lsplice(Line *pFirstLine, Line *pLastLine, long lineCt, long byteCt, Buffer *pBuf, Line *pLine2);
 extern void lunlink(Line *pLine, Buffer *pBuf);
+extern void lxfree(LineIndex *pLineIdx);
+extern void lxinit(LineIndex *pLineIdx);
 extern int makeArray(Datum *pRtnVal, ArraySize len, Array **ppAry);
 extern char *makeLower(char *dest, const char *src);
 extern char *makeUpper(char *dest, const char *src);
@@ -1263,6 +1366,7 @@ extern int moveLine(int n);
 extern void movePoint(Point *pPoint);
 extern int moveWord(int n);
 extern int moveWindUp(Datum *pRtnVal, int n, Datum **args);
+extern void mregfree(MarkReg *pMarkReg);
 extern ModeSpec *msrch(const char *name, ssize_t *index);
 extern int narrowBuf(Datum *pRtnVal, int n, Datum **args);
 extern int newCol(short c, int col);
@@ -1364,6 +1468,7 @@ extern int tgetc(bool msgLine, ushort *pChar);
 extern int tflush(void);
 extern int tmove(int row, int col);
 extern int topen(void);
+extern bool tready(int fd, int timeout);
 extern void trev(bool msgLine, bool attrOn);
 extern void tul(bool msgLine, bool attrOn);
 extern int typahead(int *pCount);
@@ -1374,6 +1479,8 @@ extern long urand(long upperBound);
 extern int userPrompt(Datum *pRtnVal, int n, Datum **args);
 extern bool validMark(Datum *pDatum);
 extern int vtinit(void);
+extern void wattach(EWindow *pWind, Buffer *pBuf);
+extern void wdetach(EWindow *pWind);
 extern void windFaceToBufFace(EWindow *pWind, Buffer *pBuf);
 extern EWindow *windDispBuf(Buffer *pBuf, bool skipCur);
 extern int widenBuf(Datum *pRtnVal, int n, Datum **args);
@@ -1402,6 +1509,7 @@ Option bufAttrTable[] = {		// Buffer attribute table.
 	{"Active", NULL, OptIgnore, BFActive},
 	{"^Changed", "^Chg", 0, BFChanged},
 	{"Command", NULL, OptIgnore, BFCommand},
+	{"^Follow", "^Fol", 0, BFFollow},
 	{"Function", NULL, OptIgnore, BFFunc},
 	{"^Hidden", "^Hid", 0, BFHidden},
 	{"Narrowed", NULL, OptIgnore, BFNarrowed},
@@ -1453,7 +1561,7 @@ SampBuf sampBuf;			// "Sample" string buffer.
 uint scratchBufNum = 0;			// Unique suffix number for scratch buffers.
 SessionCtrl sess = {			// Session parameters.
 	{NULL, NULL, NULL, NULL}, {NULL, NULL, NULL, NULL}, NULL, FencePause, AutoSaveTrig, AutoSaveTrig, 0,
-	OpEval | OpStartup | OpScrnRedraw, PageOverlap, NULL, NULL, NULL, NULL, NULL, TravJump, 0, {Success, 0}, {Success, 0}
+	OpEval | OpStartup | OpScrnRedraw, PageOverlap, NULL, NULL, NULL, NULL, NULL, TravJump, 0, {Success, 0}, {Success, 0}, 0, 0
 	};
 ETerm term = {
 	TTY_MaxCols,			// Maximum number of columns.
@@ -12,7 +12,7 @@ typedef enum {
 	sv_RegionText, sv_ReturnMsg, sv_RingNames, sv_RunFile, sv_RunName, sv_ScreenCount, sv_TermSize, sv_WindCount,
 
 	// Mutables.
-	sv_autoSave, sv_bufFile, sv_bufLineNum, sv_bufname, sv_execPath, sv_fencePause, sv_hardTabSize, sv_horzJump,
+	sv_autoSave, sv_bufFile, sv_bufLineNum, sv_bufMemLimit, sv_bufname, sv_execPath, sv_fencePause, sv_hardTabSize, sv_horzJump,
 	sv_inpDelim, sv_lastKeySeq, sv_lineChar, sv_lineCol, sv_lineOffset, sv_lineText, sv_maxCallDepth, sv_maxLoop,
 	sv_maxPromptPct, sv_otpDelim, sv_pageOverlap, sv_replacePat, sv_screenNum, sv_searchDelim, sv_searchPat, sv_softTabSize,
 	sv_travJump, sv_vertJump, sv_windLineNum, sv_windNum, sv_windSize, sv_workDir, sv_wrapCol
@@ -131,6 +131,7 @@ SysVar sysVars[] = {
 	{"$autoSave",		sv_autoSave,		V_Int,			VLit_autoSave},
 	{"$bufFile",		sv_bufFile,		V_Nil,			VLit_bufFile},
 	{"$bufLineNum",		sv_bufLineNum,		V_Int,			VLit_bufLineNum},
+	{"$bufMemLimit",	sv_bufMemLimit,		V_Int,			VLit_bufMemLimit},
 	{"$bufname",		sv_bufname,		0,			VLit_bufname},
 	{"$execPath",		sv_execPath,		V_Nil,			VLit_execPath},
 	{"$fencePause",		sv_fencePause,		V_Int,			VLit_fencePause},
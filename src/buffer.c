@@ -229,6 +229,8 @@ Retn:
 // Clear a buffer's filename, if any.
 void clearBufFilename(Buffer *pBuf) {
 
+	followEnd(pBuf);
+	journalEnd(pBuf, true);
 	if(pBuf->filename != NULL) {
 		free((void *) pBuf->filename);
 		pBuf->filename = NULL;
@@ -417,6 +419,8 @@ int narrowBuf(Datum *pRtnVal, int n, Datum **args) {
 	Mark *pMark;
 	Line *pLine, *pLine1, *pLineEnd;
 	const char *errorMsg;
+	long lineCount = 0;
+	long byteCount = 0;
 	Point *pPoint = &sess.cur.pFace->point;
 
 	// Make sure we aren't already narrowed or buffer is empty.
@@ -473,6 +477,7 @@ ErrRtn:
 		return sess.rtn.status;
 
 	// Current line is now at top of area to be narrowed and n is the number of lines (forward).
+	lxfree(&sess.cur.pBuf->lineIdx);				// Line numbers will change.
 	pLine = pPoint->pLine;
 	pLine1 = sess.cur.pBuf->pFirstLine;				// Save original first line of buffer...
 	pLineEnd = pLine1->prev;					// and last line.
@@ -486,8 +491,10 @@ ErrRtn:
 		pLine1->prev = pLine->prev;				// and save pointer to last line of fragment.
 		}
 
-	// Move point forward to line just past the end of the narrowed region.
+	// Move point forward to line just past the end of the narrowed region, totaling its lines and bytes.
 	do {
+		++lineCount;
+		byteCount += pPoint->pLine->used;
 		if((pPoint->pLine = pPoint->pLine->next) == NULL) {	// If narrowed region extends to bottom of buffer...
 			sess.cur.pBuf->pNarBotLine = NULL;		// set old first line to NULL (no bottom fragment)...
 			sess.cur.pBuf->pFirstLine->prev = pLineEnd;	// and point narrowed first line to original last line.
@@ -501,6 +508,12 @@ ErrRtn:
 	sess.cur.pBuf->pFirstLine->prev = pPoint->pLine->prev;	// set new last line of buffer...
 	pPoint->pLine->prev = pLineEnd;				// and save pointer to last line of fragment.
 FixMarks:
+	// Set line and byte totals of narrowed region and hidden fragments.
+	sess.cur.pBuf->narLineTotal = sess.cur.pBuf->lineTotal - lineCount;
+	sess.cur.pBuf->narByteTotal = sess.cur.pBuf->byteTotal - byteCount;
+	sess.cur.pBuf->lineTotal = lineCount;
+	sess.cur.pBuf->byteTotal = byteCount;
+
 	// Inactivate marks outside of narrowed region.
 	markOff();
 
@@ -548,6 +561,7 @@ static void unnarrow(Buffer *pBuf) {
 	dumpBuffer("unnarrow(): BEFORE", NULL, true);
 #endif
 	// Get narrowed first and last lines.
+	lxfree(&pBuf->lineIdx);
 	pLine1 = pBuf->pFirstLine;
 	pLineEnd = pLine1->prev;
 
@@ -571,6 +585,9 @@ static void unnarrow(Buffer *pBuf) {
 		pBuf->pFirstLine->prev = pLine;		// point first line going backward to last line...
 		pBuf->pNarBotLine = NULL;		// and deactivate bottom fragment.
 		}
+	pBuf->lineTotal += pBuf->narLineTotal;		// Add hidden lines and bytes back into buffer totals.
+	pBuf->byteTotal += pBuf->narByteTotal;
+	pBuf->narLineTotal = pBuf->narByteTotal = 0;
 
 	// Activate all marks in buffer.
 	pMark = &pBuf->markHdr;
@@ -837,8 +854,12 @@ int bfind(const char *name, ushort ctrlFlags, ushort bufFlags, Buffer **ppBuf, b
 		if((ctrlFlags & BS_Confirm) && opConfirm(BF_CreateBuf) != Success)
 			return sess.rtn.status;
 
-		// Allocate memory for the first line.
-		if(lalloc(0, &pLine) != Success)
+		// Initialize line pool and allocate memory for the first line.
+		lpinit(&newBuf.linePool);
+		lxinit(&newBuf.lineIdx);
+		newBuf.lineTotal = 1;
+		newBuf.byteTotal = newBuf.narLineTotal = newBuf.narByteTotal = 0;
+		if(lalloc(0, &newBuf, &pLine) != Success)
 			return sess.rtn.status;		// Fatal error.
 		newBuf.pFirstLine = pLine->prev = pLine;
 		pLine->next = NULL;
@@ -856,6 +877,18 @@ int bfind(const char *name, ushort ctrlFlags, ushort bufFlags, Buffer **ppBuf, b
 		newBuf.flags = bufFlags | BFActive;
 		newBuf.modes = NULL;
 		newBuf.windCount = newBuf.aliasCount = 0;
+		newBuf.pWindHead = NULL;
+		newBuf.markReg.table = NULL;
+		newBuf.markReg.size = 0;
+		newBuf.markReg.valid = false;
+		newBuf.evictPos = NULL;
+		newBuf.lastUse = 0;
+		newBuf.pFollow = NULL;
+		newBuf.pJrnl = NULL;
+		newBuf.readSize = 0;
+		newBuf.statSize = -1;
+		newBuf.statTime = 0;
+		newBuf.textHash = 0;
 		newBuf.saveDir = NULL;
 		newBuf.filename = NULL;
 		strcpy(newBuf.bufname, bufname);
@@ -898,25 +931,47 @@ static int bfree(Buffer *pBuf) {
 	EScreen *pScrn;
 	EWindow *pWind;
 
-	// Free all line objects except the first.
-	for(pLine = pBuf->pFirstLine->prev; pLine != pBuf->pFirstLine; pLine = pLine1) {
-		pLine1 = pLine->prev;
-		free((void *) pLine);
-		}
+	lxfree(&pBuf->lineIdx);
 
-	// Free first line of buffer.  If allocated size is small, keep line and simply set "used" size to zero.  Otherwise,
-	// allocate a new empty line for buffer so that memory is freed.
-	if(pLine->size <= (LineBlockSize << 1)) {
-		pLine->used = 0;
-		pLine->prev = pLine;
+	// If buffer is not narrowed, all lines are being freed.  Free any oversize lines individually, then release the line
+	// pool in one step and allocate a new empty first line.
+	if(!(pBuf->flags & BFNarrowed)) {
+		if(pBuf->linePool.bigCount > 0) {
+			pLine = pBuf->pFirstLine;
+			do {
+				pLine1 = pLine->next;
+				if(pLine->size > LinePoolMax)
+					lrelease(pLine, pBuf);
+				} while((pLine = pLine1) != NULL);
+			}
+		lpfree(&pBuf->linePool);
+		if(lalloc(0, pBuf, &pLine) != Success)
+			return sess.rtn.status;		// Fatal error.
+		pBuf->pFirstLine = pLine->prev = pLine;
 		}
 	else {
-		if(lalloc(0, &pLine1) != Success)
-			return sess.rtn.status;		// Fatal error.
-		free((void *) pLine);
-		pBuf->pFirstLine = pLine1->prev = pLine = pLine1;
+		// Free all line objects except the first.
+		for(pLine = pBuf->pFirstLine->prev; pLine != pBuf->pFirstLine; pLine = pLine1) {
+			pLine1 = pLine->prev;
+			lrelease(pLine, pBuf);
+			}
+
+		// Free first line of buffer.  If allocated size is small, keep line and simply set "used" size to zero.
+		// Otherwise, allocate a new empty line for buffer so that memory is freed.
+		if(pLine->size <= (LineBlockSize << 1)) {
+			pLine->used = 0;
+			pLine->prev = pLine;
+			}
+		else {
+			lrelease(pLine, pBuf);
+			if(lalloc(0, pBuf, &pLine1) != Success)
+				return sess.rtn.status;		// Fatal error.
+			pBuf->pFirstLine = pLine1->prev = pLine = pLine1;
+			}
 		}
 	pLine->next = NULL;
+	pBuf->lineTotal = 1;
+	pBuf->byteTotal = 0;
 
 	// Reset window line links.
 
@@ -1016,6 +1071,12 @@ int bclear(Buffer *pBuf, ushort flags) {
 	if(bconfirm(pBuf, flags) != Success)
 		return sess.rtn.status;
 
+	// Discard any positions saved when buffer text was evicted.
+	if(pBuf->evictPos != NULL) {
+		free((void *) pBuf->evictPos);
+		pBuf->evictPos = NULL;
+		}
+
 	// Buffer already empty?  If so and no flags specified, just reset buffer.
 	if(bempty(pBuf) && flags == 0)
 		goto Unchange;
@@ -1032,6 +1093,7 @@ int bclear(Buffer *pBuf, ushort flags) {
 		Mark *pMark = &pBuf->markHdr;			// set all non-window visible marks to beginning of first line.
 		do {
 			if(pMark->id <= '~' && pMark->point.offset >= 0) {
+				mregclear(pBuf);
 				pMark->point.pLine = pBuf->pFirstLine;
 				pMark->point.offset = 0;
 				}
@@ -1089,7 +1151,8 @@ Retn:
 	}
 
 // Change zero or more buffer attributes (flags), given result pointer and action (n < 0: clear, n == 0 (default): toggle,
-// n == 1: set, or n > 1: clear all and set).  Mutable attributes are: "Changed", "Hidden", and "TermAttr".
+// n == 1: set, or n > 1: clear all and set).  Mutable attributes are: "Changed", "Follow", "Hidden", "ReadOnly", and
+// "TermAttr".
 // If interactive:
 //	. Prompt for one (if default n) or more (otherwise) single-letter attributes via parseOpts().
 //	. Use current buffer if default n; otherwise, prompt for buffer name.
@@ -1171,7 +1234,7 @@ SetFlags:
 	// Have flag(s) and buffer.  Perform operation.
 	oldBufFlags = newBufFlags = pBuf->flags;
 	if(action > 1)
-		newBufFlags &= ~(BFChanged | BFHidden | BFReadOnly | BFTermAttr);
+		newBufFlags &= ~(BFChanged | BFFollow | BFHidden | BFReadOnly | BFTermAttr);
 	if(newFlags != 0) {
 		if(action < 0)
 			newBufFlags &= ~newFlags;			// Clear.
@@ -1198,8 +1261,16 @@ SetFlags:
 			}
 		}
 
-	// All is well... set new buffer flags.
+	// All is well... set new buffer flags, then start or stop following buffer's file if needed.
 	pBuf->flags = newBufFlags;
+	if((oldBufFlags & BFFollow) != (newBufFlags & BFFollow)) {
+		if(!(newBufFlags & BFFollow))
+			followEnd(pBuf);
+		else if(followBuf(pBuf) != Success) {
+			pBuf->flags &= ~BFFollow;
+			return sess.rtn.status;
+			}
+		}
 
 	// Set window flags if needed.
 	windFlags = (oldBufFlags & (BFChanged | BFReadOnly)) != (newBufFlags & (BFChanged | BFReadOnly)) ? WFMode : 0;
@@ -1266,16 +1337,13 @@ int bufOp(Datum *pRtnVal, int n, const char *prompt, uint op, int flag) {
 				}
 			break;
 		case BO_GotoLine:
-			// Go to beginning of buffer and count lines.
+			// Go to beginning of buffer and move to line (or last line if line number is out of range).
 			pPoint->pLine = pBuf->pFirstLine;
 			pPoint->offset = 0;
 			if(pBuf == sess.cur.pBuf)
 				return moveLine(flag - 1);
-			for(--flag; flag > 0; --flag) {
-				if(pPoint->pLine->next == NULL)
-					break;
-				pPoint->pLine = pPoint->pLine->next;
-				}
+			if(flag > 1 && (pPoint->pLine = getLinePtr(pBuf, flag)) == NULL)
+				pPoint->pLine = pBuf->pFirstLine->prev;
 			break;
 		default:	// BO_ReadBuf
 			// Read next line from buffer n times.
@@ -1317,9 +1385,163 @@ int sysBuf(const char *root, Buffer **ppBuf, ushort flags) {
 	return bfind(bufname, BS_Create | BS_Force, BFHidden | flags, ppBuf, NULL);
 	}
 
-// Activate a buffer if needed.  Return status.
+// Return approximate amount of memory in bytes used by given buffer's text.
+static long bufMem(Buffer *pBuf) {
+
+	return pBuf->byteTotal + pBuf->narByteTotal + (pBuf->lineTotal + pBuf->narLineTotal) * (long) sizeof(Line);
+	}
+
+// Check if given buffer's text can be evicted and return Boolean result.  The buffer must be active, unchanged, not narrowed, not
+// followed, not displayed, not current, not in use by the script processor, and must have a file (reachable from the current
+// directory) to restore its text from.
+static bool evictable(Buffer *pBuf) {
+
+	return (pBuf->flags & (BFActive | BFChanged | BFCmdFunc | BFFollow | BFHidden | BFNarrowed | BFPreproc)) ==
+	 BFActive && pBuf->pWindHead == NULL && pBuf != sess.cur.pBuf && pBuf != sess.edit.pBuf && pBuf->filename != NULL &&
+	 (pBuf->saveDir == NULL || pBuf->saveDir == sess.cur.pScrn->workDir) &&
+	 (fileExists(pBuf->filename) & (FTypRegular | FTypSymLink));
+	}
+
+// Drop the text of given buffer and mark it inactive so that it will be re-read by bactivate() when next used.  The line
+// numbers of the buffer face and all marks are saved in the evictPos array (in that order) and their offsets are left as is.
+// Return status.
+static int bevict1(Buffer *pBuf) {
+	Mark *pMark;
+	long *pPos;
+	int n = 2;
+
+	pMark = &pBuf->markHdr;
+	do {
+		++n;
+		} while((pMark = pMark->next) != NULL);
+	if((pBuf->evictPos = pPos = (long *) malloc(n * sizeof(long))) == NULL)
+		return rsset(Panic, 0, text94, "bevict1");
+				// "%s(): Out of memory!"
+	*pPos++ = getLineNum(pBuf, pBuf->face.pTopLine);
+	*pPos++ = getLineNum(pBuf, pBuf->face.point.pLine);
+	pMark = &pBuf->markHdr;
+	do {
+		*pPos++ = (pMark->point.offset >= 0) ? getLineNum(pBuf, pMark->point.pLine) : 1;
+		} while((pMark = pMark->next) != NULL);
+
+	// Free the text and point everything at the remaining empty line.
+	if(bfree(pBuf) != Success)
+		return sess.rtn.status;
+	pBuf->face.pTopLine = pBuf->face.point.pLine = pBuf->pFirstLine;
+	pMark = &pBuf->markHdr;
+	do {
+		pMark->point.pLine = pBuf->pFirstLine;
+		} while((pMark = pMark->next) != NULL);
+	mregclear(pBuf);
+	pBuf->flags &= ~BFActive;
+
+	return sess.rtn.status;
+	}
+
+// Re-read the text of a buffer that was evicted by bevict() and restore its face and marks.  Return status.
+static int brestore(Buffer *pBuf) {
+	Mark *pMark, markHdr;
+	Face face;
+	long *evictPos, *pPos;
+	Line *pLine;
+
+	// Detach saved state from buffer so that readIn() leaves it alone, then read the file.
+	evictPos = pBuf->evictPos;
+	pBuf->evictPos = NULL;
+	face = pBuf->face;
+	markHdr = pBuf->markHdr;
+	pBuf->markHdr.next = NULL;
+	if(readIn(pBuf, NULL, RWKeep) <= FatalError) {
+		free((void *) evictPos);
+		return sess.rtn.status;
+		}
+
+	// Restore face and marks, clamped to the text that was read.
+	pBuf->face = face;
+	pBuf->markHdr = markHdr;
+	pPos = evictPos;
+	if((pLine = getLinePtr(pBuf, *pPos++)) == NULL)
+		pLine = pBuf->pFirstLine->prev;
+	pBuf->face.pTopLine = pLine;
+	if((pLine = getLinePtr(pBuf, *pPos++)) == NULL)
+		pLine = pBuf->pFirstLine->prev;
+	pBuf->face.point.pLine = pLine;
+	if(pBuf->face.point.offset > pLine->used)
+		pBuf->face.point.offset = pLine->used;
+	pMark = &pBuf->markHdr;
+	do {
+		if((pLine = getLinePtr(pBuf, *pPos++)) == NULL)
+			pLine = pBuf->pFirstLine->prev;
+		pMark->point.pLine = pLine;
+		if(pMark->point.offset > pLine->used)
+			pMark->point.offset = pLine->used;
+		} while((pMark = pMark->next) != NULL);
+	mregclear(pBuf);
+	free((void *) evictPos);
+
+	return sess.rtn.status;
+	}
+
+// Compare use-clock values of two buffers (for qsort()).
+static int bufUsecmp(const void *ppBuf1, const void *ppBuf2) {
+	ulong lastUse1 = (*((Buffer **) ppBuf1))->lastUse;
+	ulong lastUse2 = (*((Buffer **) ppBuf2))->lastUse;
+
+	return lastUse1 < lastUse2 ? -1 : lastUse1 > lastUse2;
+	}
+
+// Enforce the buffer memory budget ($bufMemLimit).  If the text of all active buffers exceeds it, evict buffers per
+// evictable() in least-recently-used order until the total is within budget or no more buffers qualify.  Called between
+// commands only (by editLoop()).  Return status.
+int bevict(void) {
+	Datum *pArrayEl;
+	Array *pArray;
+	Buffer *pBuf, **bufList, **ppBuf, **ppBufEnd;
+	long total, limit;
+
+	if(sess.bufMemLimit == 0)
+		return sess.rtn.status;
+
+	// Get total memory in use.
+	total = 0;
+	pArray = &bufTable;
+	while((pArrayEl = aeach(&pArray)) != NULL) {
+		pBuf = bufPtr(pArrayEl);
+		if(pBuf->flags & BFActive)
+			total += bufMem(pBuf);
+		}
+	limit = sess.bufMemLimit * 1024;
+	if(total <= limit)
+		return sess.rtn.status;
+
+	// Over budget.  Get list of evictable buffers and sort it, oldest first.
+	if((bufList = (Buffer **) malloc(bufTable.used * sizeof(Buffer *))) == NULL)
+		return rsset(Panic, 0, text94, "bevict");
+			// "%s(): Out of memory!"
+	ppBufEnd = bufList;
+	pArray = &bufTable;
+	while((pArrayEl = aeach(&pArray)) != NULL)
+		if(evictable(pBuf = bufPtr(pArrayEl)))
+			*ppBufEnd++ = pBuf;
+	qsort((void *) bufList, ppBufEnd - bufList, sizeof(Buffer *), bufUsecmp);
+
+	// Evict oldest buffers until total is within budget.
+	for(ppBuf = bufList; total > limit && ppBuf < ppBufEnd; ++ppBuf) {
+		total -= bufMem(*ppBuf);
+		if(bevict1(*ppBuf) != Success)
+			break;
+		}
+	free((void *) bufList);
+
+	return sess.rtn.status;
+	}
+
+// Activate a buffer if needed.  If buffer's text was evicted by bevict(), the file is re-read quietly and point, the window
+// face, and all marks are restored to their saved line numbers and offsets.  Return status.
 int bactivate(Buffer *pBuf) {
 
+	pBuf->lastUse = ++sess.useClock;
+
 	// Check if buffer is active.
 	if(!(pBuf->flags & BFActive)) {
 
@@ -1332,6 +1554,9 @@ int bactivate(Buffer *pBuf) {
 			(void) rsset(Failure, RSHigh, text141, workBuf, pBuf->filename);
 				// "I/O Error: %s, file \"%s\""
 			}
+		else if(pBuf->evictPos != NULL)
+			// Text was evicted.  Read it back.
+			(void) brestore(pBuf);
 		else
 			// All is well.  Read attached file into buffer.
 			(void) readIn(pBuf, NULL, RWReadHook | RWKeep | RWStats);
@@ -1551,14 +1776,13 @@ int bswitch(Buffer *pBuf, ushort flags) {
 		return sess.rtn.status;
 
 	// Decrement window use count of current (old) buffer and save the current window settings.
-	--sess.cur.pBuf->windCount;
+	wdetach(sess.cur.pWind);
 	windFaceToBufFace(sess.cur.pWind, sess.cur.pBuf);
 	if(!(flags & SWB_NoLastBuf))
 		sess.cur.pScrn->pLastBuf = sess.cur.pBuf;
 
 	// Switch to new buffer.
-	sess.cur.pWind->pBuf = sess.edit.pBuf = sess.cur.pBuf = pBuf;
-	++pBuf->windCount;
+	wattach(sess.cur.pWind, sess.edit.pBuf = sess.cur.pBuf = pBuf);
 
 	// Activate buffer.
 	if(bactivate(sess.cur.pBuf) <= MinExit)
@@ -1702,6 +1926,7 @@ void delBufMarks(Buffer *pBuf, ushort flags) {
 		}
 
 	// Initialize root mark to end of buffer.
+	mregclear(pBuf);
 	pMark->id = RegionMark;
 	pMark->point.offset = (pMark->point.pLine = pBuf->pFirstLine->prev)->used;
 	pMark->reframeRow = 0;
@@ -1820,6 +2045,9 @@ int bdelete(Buffer *pBuf, ushort flags) {
 	preprocFree(pBuf);				// Release any script preprocessor storage.
 	if(pBuf->pCallInfo != NULL)
 		free((void *) pBuf->pCallInfo);		// Release buffer extension record.
+	lpfree(&pBuf->linePool);			// Release line storage...
+	lxfree(&pBuf->lineIdx);				// and line index...
+	mregfree(&pBuf->markReg);			// and mark registry.
 	dfree(delistBuf(pBuf));				// Remove from buffer list and destroy Buffer and Datum objects.
 	if(pKeyBind != NULL)
 		unbind(pKeyBind);			// Delete buffer key binding.
@@ -2190,21 +2418,25 @@ int renameBuf(Datum *pRtnVal, int n, Datum **args) {
 
 // Get size of a buffer in lines and bytes.  Set *pLineCount to line count if not NULL and return byte count.
 long bufLength(Buffer *pBuf, int *pLineCount) {
+
+#if MMDebug & Debug_BufTotals
+	// Verify running totals with a full walk of the buffer.
+	long lineCt = 0;
 	long byteCt = 0;
-	int lineCount = 0;
 	Line *pLine = pBuf->pFirstLine;
 
-	while(pLine->next != NULL) {			// Count all lines except the last...
-		++lineCount;
-		byteCt += pLine->used + 1;
-		pLine = pLine->next;
-		}
-	byteCt += pLine->used;				// count bytes in last line...
-	if(pLine->used > 0)				// and bump line count if last line not empty.
-		++lineCount;
+	do {
+		++lineCt;
+		byteCt += pLine->used;
+		} while((pLine = pLine->next) != NULL);
+	if(lineCt != pBuf->lineTotal || byteCt != pBuf->byteTotal)
+		fprintf(logfile, "bufLength(): Buffer '%s' totals %ld lines, %ld bytes; actual %ld lines, %ld bytes\n",
+		 pBuf->bufname, pBuf->lineTotal, pBuf->byteTotal, lineCt, byteCt);
+#endif
+	// Newlines delimit all lines except the last.  Last line is counted only if it is not empty.
 	if(pLineCount != NULL)
-		*pLineCount = lineCount;
-	return byteCt;
+		*pLineCount = pBuf->lineTotal - (pBuf->pFirstLine->prev->used == 0);
+	return pBuf->byteTotal + pBuf->lineTotal - 1;
 	}
 
 // Add text (which may contain newlines) to the end of the given buffer and return status.  Note that (1), this works on
@@ -2221,7 +2453,7 @@ int bappend(Buffer *pBuf, const char *text) {
 		if(*str1 == '\n' || *str1 == '\0') {
 
 			// Allocate memory for the line and copy it over.
-			if(lalloc(str1 - str0, &pLine) != Success)
+			if(lalloc(str1 - str0, pBuf, &pLine) != Success)
 				return sess.rtn.status;
 			if(str1 > str0)
 				memcpy(pLine->text, str0, str1 - str0);
@@ -211,6 +211,26 @@ void windFaceToBufFace(EWindow *pWind, Buffer *pBuf) {
 	pBuf->face = pWind->face;
 	}
 
+// Attach a window to given buffer: set its buffer pointer, bump the buffer's window count, and add window to the buffer's window
+// registry.
+void wattach(EWindow *pWind, Buffer *pBuf) {
+
+	pWind->pBuf = pBuf;
+	++pBuf->windCount;
+	pWind->pNextBufWind = pBuf->pWindHead;
+	pBuf->pWindHead = pWind;
+	}
+
+// Detach a window from its buffer: decrement the buffer's window count and remove window from the buffer's window registry.
+void wdetach(EWindow *pWind) {
+	EWindow **ppWind = &pWind->pBuf->pWindHead;
+
+	--pWind->pBuf->windCount;
+	while(*ppWind != pWind)
+		ppWind = &(*ppWind)->pNextBufWind;
+	*ppWind = pWind->pNextBufWind;
+	}
+
 // Get ordinal number of given window, beginning at 1.
 int getWindNum(EWindow *pWind) {
 	EWindow *pWind1 = sess.windHead;
@@ -449,7 +469,7 @@ int onlyWind(Datum *pRtnVal, int n, Datum **args) {
 	while(sess.windHead != sess.cur.pWind) {
 		pWind = sess.windHead;
 		sess.cur.pScrn->windHead = sess.windHead = pWind->next;
-		--pWind->pBuf->windCount;
+		wdetach(pWind);
 		windFaceToBufFace(pWind, pWind->pBuf);
 		free((void *) pWind);
 		}
@@ -458,7 +478,7 @@ int onlyWind(Datum *pRtnVal, int n, Datum **args) {
 	while(sess.cur.pWind->next != NULL) {
 		pWind = sess.cur.pWind->next;
 		sess.cur.pWind->next = pWind->next;
-		--pWind->pBuf->windCount;
+		wdetach(pWind);
 		windFaceToBufFace(pWind, pWind->pBuf);
 		free((void *) pWind);
 		}
@@ -581,7 +601,7 @@ static int delJoinWind(int n, Datum **args, bool join) {
 		}
 
 	// Get rid of the current window.
-	--sess.cur.pBuf->windCount;
+	wdetach(sess.cur.pWind);
 	windFaceToBufFace(sess.cur.pWind, sess.cur.pBuf);
 	free((void *) sess.cur.pWind);
 
@@ -690,8 +710,7 @@ int wsplit(int n, EWindow **ppWind) {
 		++pointRow;
 
 	// Update some settings.
-	++sess.cur.pBuf->windCount;				// Now displayed twice (or more).
-	pWind->pBuf = sess.cur.pBuf;
+	wattach(pWind, sess.cur.pBuf);				// Now displayed twice (or more).
 	pWind->face = *pFace;					// For now.
 	pWind->reframeRow = 0;
 	pWind->flags = WFHard | WFMode;
@@ -1265,8 +1284,7 @@ int sfind(ushort scrNum, Buffer *pBuf, EScreen **ppScrn) {
 
 		// and set up the window's info.
 		pWind->next = NULL;
-		pWind->pBuf = pBuf;
-		++pBuf->windCount;
+		wattach(pWind, pBuf);
 		bufFaceToWindFace(pBuf, pWind);
 		pWind->id = id;
 		pWind->topRow = 0;
@@ -1451,7 +1469,7 @@ static void freeScrn(EScreen *pScrn) {
 	// First, free the screen's windows...
 	pWind = pScrn->windHead;
 	do {
-		--pWind->pBuf->windCount;
+		wdetach(pWind);
 		windFaceToBufFace(pWind, pWind->pBuf);
 
 		// On to the next window; free this one.
@@ -12,30 +12,513 @@
 #include <ctype.h>
 #include "bind.h"
 #include "exec.h"
+#include "file.h"
 #include "search.h"
 
 // Local definitions.
 #define BlockSize(a)	((a + LineBlockSize) & ~(LineBlockSize - 1))
+#define LineObjSize(size) ((offsetof(Line, text) + size + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
 #define min(a, b)	((b < a) ? b : a)
 
-// Allocate a block of memory large enough to hold a Line containing "used" characters and set *ppLine to the new block.
-// Return status.
-int lalloc(int used, Line **ppLine) {
+// Initialize a line pool.
+void lpinit(LinePool *pPool) {
+	Line **ppLine = pPool->freeList;
+
+	do {
+		*ppLine++ = NULL;
+		} while(ppLine < pPool->freeList + LinePoolClasses);
+	ppLine = pPool->smallList;
+	do {
+		*ppLine++ = NULL;
+		} while(ppLine < pPool->smallList + LinePoolSmall);
+	pPool->chunkHead = NULL;
+	pPool->chunkCount = pPool->chunkBytes = pPool->lineCount = pPool->freeCount = pPool->bigCount = 0;
+	}
+
+// Release all chunks in a line pool in one step and reinitialize it.  Any pooled lines that are still in use are freed as
+// well, so the caller must ensure that none are referenced afterward.  Oversize lines (allocated individually) are not
+// affected.
+void lpfree(LinePool *pPool) {
+	LineChunk *pChunk, *pChunk1;
+	ulong bigCount = pPool->bigCount;
+
+	for(pChunk = pPool->chunkHead; pChunk != NULL; pChunk = pChunk1) {
+		pChunk1 = pChunk->next;
+		free((void *) pChunk);
+		}
+	lpinit(pPool);
+	pPool->bigCount = bigCount;
+	}
+
+// Carve a line object of given size from the current chunk of given line pool, allocating a new chunk if needed.  The first
+// chunk is small so that buffers with little text (such as user command and function buffers) use little memory; each chunk
+// after that is twice the size of the previous one, up to LinePoolChunk bytes.  Return NULL if out of memory.
+static Line *lpcarve(LinePool *pPool, size_t objSize) {
+	LineChunk *pChunk = pPool->chunkHead;
+	Line *pLine;
+	size_t chunkSize;
+
+	if(pChunk == NULL || (size_t) (pChunk->end - pChunk->avail) < objSize) {
+		if(pChunk == NULL)
+			chunkSize = LinePoolChunkMin;
+		else if((chunkSize = (pChunk->end - (char *) pChunk) * 2) > LinePoolChunk)
+			chunkSize = LinePoolChunk;
+		while(chunkSize < sizeof(LineChunk) + objSize)
+			chunkSize *= 2;
+		if((pChunk = (LineChunk *) malloc(chunkSize)) == NULL)
+			return NULL;
+		pChunk->next = pPool->chunkHead;
+		pChunk->avail = (char *) (pChunk + 1);
+		pChunk->end = (char *) pChunk + chunkSize;
+		pPool->chunkHead = pChunk;
+		++pPool->chunkCount;
+		pPool->chunkBytes += chunkSize;
+		}
+	pLine = (Line *) pChunk->avail;
+	pChunk->avail += objSize;
+	return pLine;
+	}
+
+// Get a released small line that can hold "used" characters from given line pool and return it, or NULL if none.
+static Line *lpsmall(LinePool *pPool, int used) {
+	Line *pLine, **ppFree = pPool->smallList + (used + sizeof(void *) - 1) / sizeof(void *);
+
+	for(; ppFree < pPool->smallList + LinePoolSmall; ++ppFree)
+		if((pLine = *ppFree) != NULL) {
+			*ppFree = pLine->next;
+			--pPool->freeCount;
+			return pLine;
+			}
+	return NULL;
+	}
+
+// Allocate a block of memory large enough to hold a Line containing "used" characters from given buffer's line pool and set
+// *ppLine to the new block.  If pBuf is NULL, use current edit buffer.  Lines of LinePoolMax bytes or less are reused from a
+// small free list if short enough, or carved from a pool chunk (or reused from the free list for their size class) and have
+// their size rounded up to a multiple of LineBlockSize; longer lines are allocated individually.  Return status.
+int lalloc(int used, Buffer *pBuf, Line **ppLine) {
 	Line *pLine;
+	LinePool *pPool;
+	int sizeClass;
+
+	if(pBuf == NULL)
+		pBuf = sess.edit.pBuf;
+	pPool = &pBuf->linePool;
+
+	// Oversize line?
+	if(used > LinePoolMax) {
 
-	// Use byte in text member of Line structure if possible.
-	if((pLine = (Line *) malloc(sizeof(Line) + (used > 0 ? used - 1 : 0))) == NULL)
-		return rsset(Panic, 0, text94, "lalloc");
+		// Yes, allocate it individually.
+		if((pLine = (Line *) malloc(sizeof(Line) + used - 1)) == NULL)
+			goto Fail;
+		pLine->size = used;
+		++pPool->bigCount;
+		}
+	else {
+		// No, get it from the pool.  Use a small line (keeping its size) or the free list for the size class if
+		// possible; otherwise, carve a new line from the current chunk, allocating a new chunk if needed.
+		if(used >= LineBlockSize || (pLine = lpsmall(pPool, used)) == NULL) {
+			sizeClass = (used == 0) ? 0 : (used - 1) / LineBlockSize;
+			if((pLine = pPool->freeList[sizeClass]) != NULL) {
+				pPool->freeList[sizeClass] = pLine->next;
+				--pPool->freeCount;
+				}
+			else if((pLine = lpcarve(pPool, LineObjSize((sizeClass + 1) * LineBlockSize))) == NULL)
+				goto Fail;
+			pLine->size = (sizeClass + 1) * LineBlockSize;
+			}
+		++pPool->lineCount;
+		}
+	pLine->used = used;
+	*ppLine = pLine;
+	return sess.rtn.status;
+Fail:
+	return rsset(Panic, 0, text94, "lalloc");
 			// "%s(): Out of memory!"
-	pLine->size = pLine->used = used;
+	}
+
+// Allocate a packed line containing "used" characters from given buffer's line pool and set *ppLine to it.  If pBuf is NULL,
+// use current edit buffer.  Packed lines are used for text read into a buffer.  They are carved from a pool chunk back to back
+// with no room to grow, so a packed line is replaced with a normal (size class) line by einsertc() or einsertBlk() the first
+// time text is added to it.  A short line is taken from a small free list instead if possible.  Return status.
+int lpalloc(int used, Buffer *pBuf, Line **ppLine) {
+	Line *pLine;
+	size_t objSize;
+
+	if(pBuf == NULL)
+		pBuf = sess.edit.pBuf;
+	if(used > LinePoolMax)
+		return lalloc(used, pBuf, ppLine);
+	if(used >= LineBlockSize || (pLine = lpsmall(&pBuf->linePool, used)) == NULL) {
+		if((pLine = lpcarve(&pBuf->linePool, objSize = LineObjSize(used))) == NULL)
+			return rsset(Panic, 0, text94, "lpalloc");
+				// "%s(): Out of memory!"
+		pLine->size = objSize - offsetof(Line, text);
+		}
+	pLine->used = used;
+	++pBuf->linePool.lineCount;
 	*ppLine = pLine;
 	return sess.rtn.status;
 	}
 
+// Create a packed line containing a copy of given text in given line pool and return it, or NULL if out of memory.  No
+// session state is touched, so this routine may be called by a loader thread on a private pool (see lpmerge()).
+Line *lpnew(LinePool *pPool, const char *text, int used) {
+	Line *pLine;
+	size_t objSize;
+
+	if(used > LinePoolMax) {
+		if((pLine = (Line *) malloc(sizeof(Line) + used - 1)) == NULL)
+			return NULL;
+		pLine->size = used;
+		++pPool->bigCount;
+		}
+	else {
+		if((pLine = lpcarve(pPool, objSize = LineObjSize(used))) == NULL)
+			return NULL;
+		pLine->size = objSize - offsetof(Line, text);
+		++pPool->lineCount;
+		}
+	memcpy(pLine->text, text, pLine->used = used);
+	return pLine;
+	}
+
+// Move all memory chunks and line counts from line pool pSrcPool to pDestPool and reinitialize pSrcPool.  pSrcPool must have
+// no released lines.
+void lpmerge(LinePool *pDestPool, LinePool *pSrcPool) {
+	LineChunk *pChunk;
+
+	if((pChunk = pSrcPool->chunkHead) != NULL) {
+		while(pChunk->next != NULL)
+			pChunk = pChunk->next;
+		pChunk->next = pDestPool->chunkHead;
+		pDestPool->chunkHead = pSrcPool->chunkHead;
+		}
+	pDestPool->chunkCount += pSrcPool->chunkCount;
+	pDestPool->chunkBytes += pSrcPool->chunkBytes;
+	pDestPool->lineCount += pSrcPool->lineCount;
+	pDestPool->bigCount += pSrcPool->bigCount;
+	lpinit(pSrcPool);
+	}
+
+// Release a line (which must be unlinked) back to given buffer's line pool.  If pBuf is NULL, use current edit buffer.  A
+// packed line goes on the free list of the largest size class that it can hold, or on the small free list for its size if it
+// is smaller than the smallest class.
+void lrelease(Line *pLine, Buffer *pBuf) {
+
+	if(pBuf == NULL)
+		pBuf = sess.edit.pBuf;
+	if(pLine->size > LinePoolMax) {
+		free((void *) pLine);
+		--pBuf->linePool.bigCount;
+		}
+	else {
+		Line **ppFree = (pLine->size >= LineBlockSize) ? pBuf->linePool.freeList + pLine->size / LineBlockSize - 1 :
+		 pBuf->linePool.smallList + pLine->size / sizeof(void *);
+
+		pLine->next = *ppFree;
+		*ppFree = pLine;
+		++pBuf->linePool.freeCount;
+		--pBuf->linePool.lineCount;
+		}
+	}
+
+// Initialize a line index (to the "does not exist" state).
+void lxinit(LineIndex *pLineIdx) {
+
+	pLineIdx->blocks = NULL;
+	pLineIdx->tree = NULL;
+	pLineIdx->blockCount = pLineIdx->blockMax = 0;
+	}
+
+// Free a line index, if it exists.
+void lxfree(LineIndex *pLineIdx) {
+
+	if(pLineIdx->blocks != NULL) {
+		LineBlk **ppBlk = pLineIdx->blocks;
+		LineBlk **ppBlkEnd = ppBlk + pLineIdx->blockCount;
+
+		while(ppBlk < ppBlkEnd)
+			free((void *) *ppBlk++);
+		free((void *) pLineIdx->blocks);
+		free((void *) pLineIdx->tree);
+		lxinit(pLineIdx);
+		}
+	}
+
+// Build Fenwick tree for a line index from the block line counts.
+static void lxtree(LineIndex *pLineIdx) {
+	long *tree = pLineIdx->tree;
+	int i, j;
+
+	for(i = 1; i <= pLineIdx->blockCount; ++i)
+		tree[i] = pLineIdx->blocks[i - 1]->lineCount;
+	for(i = 1; i <= pLineIdx->blockCount; ++i)
+		if((j = i + (i & -i)) <= pLineIdx->blockCount)
+			tree[j] += tree[i];
+	}
+
+// Add "delta" to line count of given block in Fenwick tree.
+static void lxadd(LineIndex *pLineIdx, int index, long delta) {
+	int i;
+
+	for(i = index + 1; i <= pLineIdx->blockCount; i += i & -i)
+		pLineIdx->tree[i] += delta;
+	}
+
+// Return number of lines in blocks preceding given block.
+static long lxsum(LineIndex *pLineIdx, int index) {
+	long sum = 0;
+
+	for(; index > 0; index -= index & -index)
+		sum += pLineIdx->tree[index];
+	return sum;
+	}
+
+// Ensure that a line index has room for "count" blocks.  Return false if out of memory.
+static bool lxgrow(LineIndex *pLineIdx, int count) {
+
+	if(count > pLineIdx->blockMax) {
+		LineBlk **blocks;
+		long *tree;
+		int blockMax = (pLineIdx->blockMax == 0) ? 16 : pLineIdx->blockMax;
+
+		while(blockMax < count)
+			blockMax *= 2;
+		if((blocks = (LineBlk **) realloc((void *) pLineIdx->blocks, blockMax * sizeof(LineBlk *))) == NULL)
+			return false;
+		pLineIdx->blocks = blocks;
+		if((tree = (long *) realloc((void *) pLineIdx->tree, (blockMax + 1) * sizeof(long))) == NULL)
+			return false;
+		pLineIdx->tree = tree;
+		pLineIdx->blockMax = blockMax;
+		}
+	return true;
+	}
+
+// Build line index for given buffer (which must not have one).  Return false if out of memory, in which case no index will
+// exist.
+static bool lxbuild(Buffer *pBuf) {
+	LineIndex *pLineIdx = &pBuf->lineIdx;
+	LineBlk *pBlk = NULL;
+	Line *pLine = pBuf->pFirstLine;
+
+	do {
+		if(pBlk == NULL || pBlk->lineCount == LineIdxBlkSize) {
+			if(!lxgrow(pLineIdx, pLineIdx->blockCount + 1) ||
+			 (pBlk = (LineBlk *) malloc(sizeof(LineBlk))) == NULL) {
+				lxfree(pLineIdx);
+				return false;
+				}
+			pBlk->pFirstLine = pLine;
+			pBlk->lineCount = 0;
+			pLineIdx->blocks[pBlk->index = pLineIdx->blockCount++] = pBlk;
+			}
+		pLine->pBlk = pBlk;
+		++pBlk->lineCount;
+		} while((pLine = pLine->next) != NULL);
+	lxtree(pLineIdx);
+	return true;
+	}
+
+// Split given line index block in two.  The index is discarded if memory cannot be obtained.
+static void lxsplit(Buffer *pBuf, LineBlk *pBlk) {
+	LineIndex *pLineIdx = &pBuf->lineIdx;
+	LineBlk *pBlk1, **ppBlk, **ppBlkEnd;
+	Line *pLine;
+	int n;
+
+	if(!lxgrow(pLineIdx, pLineIdx->blockCount + 1) || (pBlk1 = (LineBlk *) malloc(sizeof(LineBlk))) == NULL) {
+		lxfree(pLineIdx);
+		return;
+		}
+
+	// Give the second half of the lines to the new block.
+	pLine = pBlk->pFirstLine;
+	n = LineIdxBlkSize;
+	do {
+		pLine = pLine->next;
+		} while(--n > 0);
+	pBlk1->pFirstLine = pLine;
+	pBlk1->lineCount = pBlk->lineCount - LineIdxBlkSize;
+	pBlk->lineCount = LineIdxBlkSize;
+	n = pBlk1->lineCount;
+	do {
+		pLine->pBlk = pBlk1;
+		pLine = pLine->next;
+		} while(--n > 0);
+
+	// Insert new block after the old one and renumber the ones that follow.
+	ppBlkEnd = pLineIdx->blocks + pLineIdx->blockCount++;
+	ppBlk = pLineIdx->blocks + pBlk->index + 1;
+	memmove((void *) (ppBlk + 1), (void *) ppBlk, (ppBlkEnd - ppBlk) * sizeof(LineBlk *));
+	*ppBlk = pBlk1;
+	pBlk1->index = pBlk->index;
+	do {
+		(*ppBlk)->index = (*(ppBlk - 1))->index + 1;
+		} while(++ppBlk <= ppBlkEnd);
+	lxtree(pLineIdx);
+	}
+
+// Add line (which was just linked) to given buffer's line index.
+static void lxinsert(Buffer *pBuf, Line *pLine) {
+	LineBlk *pBlk;
+
+	// Add line to block of preceding line if possible; otherwise, it is the new first line of the first block.
+	if(pLine == pBuf->pFirstLine)
+		(pBlk = pLine->next->pBlk)->pFirstLine = pLine;
+	else
+		pBlk = pLine->prev->pBlk;
+	pLine->pBlk = pBlk;
+	lxadd(&pBuf->lineIdx, pBlk->index, 1);
+	if(++pBlk->lineCount >= LineIdxBlkSize * 2)
+		lxsplit(pBuf, pBlk);
+	}
+
+// Remove line (which is about to be unlinked) from given buffer's line index.
+static void lxremove(Buffer *pBuf, Line *pLine) {
+	LineIndex *pLineIdx = &pBuf->lineIdx;
+	LineBlk *pBlk = pLine->pBlk;
+
+	if(--pBlk->lineCount > 0) {
+		if(pBlk->pFirstLine == pLine)
+			pBlk->pFirstLine = pLine->next;
+		lxadd(pLineIdx, pBlk->index, -1);
+		}
+	else {
+		// Block is now empty.  Delete it and renumber the ones that follow.
+		LineBlk **ppBlk = pLineIdx->blocks + pBlk->index;
+		LineBlk **ppBlkEnd = pLineIdx->blocks + --pLineIdx->blockCount;
+
+		free((void *) pBlk);
+		while(ppBlk < ppBlkEnd) {
+			*ppBlk = ppBlk[1];
+			(*ppBlk)->index = ppBlk - pLineIdx->blocks;
+			++ppBlk;
+			}
+		lxtree(pLineIdx);
+		}
+	}
+
+// Remove the lines following pLine1 through pLine2 (which are about to be unlinked as a sub-list) from given buffer's line
+// index, if it exists.  Lines are removed a block at a time and any blocks that become empty are deleted.
+static void lxremoveBlk(Buffer *pBuf, Line *pLine1, Line *pLine2) {
+	LineIndex *pLineIdx = &pBuf->lineIdx;
+
+	if(pLineIdx->blocks != NULL) {
+		LineBlk *pBlk, **ppBlk, **ppBlk1, **ppBlkEnd;
+		Line *pLine = pLine1;
+		int n;
+		bool emptied = false;
+
+		do {
+			// Count run of lines in next block.  Any remaining lines in the block follow pLine2.
+			pBlk = (pLine = pLine->next)->pBlk;
+			if(pBlk->pFirstLine == pLine)
+				pBlk->pFirstLine = pLine2->next;
+			n = 1;
+			while(pLine != pLine2 && pLine->next->pBlk == pBlk) {
+				pLine = pLine->next;
+				++n;
+				}
+			if((pBlk->lineCount -= n) == 0)
+				emptied = true;
+			else
+				lxadd(pLineIdx, pBlk->index, -n);
+			} while(pLine != pLine2);
+
+		// Delete any empty blocks and renumber the ones that remain.
+		if(emptied) {
+			ppBlkEnd = (ppBlk = ppBlk1 = pLineIdx->blocks) + pLineIdx->blockCount;
+			do {
+				if((*ppBlk)->lineCount == 0)
+					free((void *) *ppBlk);
+				else {
+					*ppBlk1 = *ppBlk;
+					(*ppBlk1)->index = ppBlk1 - pLineIdx->blocks;
+					++ppBlk1;
+					}
+				} while(++ppBlk < ppBlkEnd);
+			pLineIdx->blockCount = ppBlk1 - pLineIdx->blocks;
+			lxtree(pLineIdx);
+			}
+		}
+	}
+
+// Replace line pLine1 with pLine2 in given buffer's line index.
+static void lxreplace(Line *pLine1, Line *pLine2) {
+	LineBlk *pBlk = pLine2->pBlk = pLine1->pBlk;
+
+	if(pBlk->pFirstLine == pLine1)
+		pBlk->pFirstLine = pLine2;
+	}
+
+// Get line number, given buffer and line pointer.
+long getLineNum(Buffer *pBuf, Line *pTargLine) {
+	Line *pLine;
+	long n = 0;
+
+	// Use line index if possible.
+	if(pBuf->lineIdx.blocks != NULL || lxbuild(pBuf)) {
+		LineBlk *pBlk = pTargLine->pBlk;
+
+		for(pLine = pTargLine; pLine != pBlk->pFirstLine; pLine = pLine->prev)
+			++n;
+		return lxsum(&pBuf->lineIdx, pBlk->index) + n + 1;
+		}
+
+	// No index (out of memory).  Start at the beginning of the buffer and count lines.
+	pLine = pBuf->pFirstLine;
+	do {
+		// If we have reached the target line, stop.
+		if(pLine == pTargLine)
+			break;
+		++n;
+		} while((pLine = pLine->next) != NULL);
+
+	// Return result.
+	return n + 1;
+	}
+
+// Get pointer to line, given buffer and line number.  Return NULL if line number is out of range.
+Line *getLinePtr(Buffer *pBuf, long lineNum) {
+	Line *pLine;
+
+	if(lineNum <= 0)
+		return NULL;
+	if(pBuf->lineIdx.blocks != NULL || lxbuild(pBuf)) {
+		LineIndex *pLineIdx = &pBuf->lineIdx;
+		long *tree = pLineIdx->tree;
+		int index = 0;
+		int step = 1;
+
+		// Find block containing the line via binary descent of Fenwick tree, then walk to it.
+		while(step * 2 <= pLineIdx->blockCount)
+			step *= 2;
+		--lineNum;
+		do {
+			if(index + step <= pLineIdx->blockCount && tree[index + step] <= lineNum)
+				lineNum -= tree[index += step];
+			} while((step /= 2) > 0);
+		if(index == pLineIdx->blockCount)
+			return NULL;
+		for(pLine = pLineIdx->blocks[index]->pFirstLine; lineNum > 0; --lineNum)
+			pLine = pLine->next;
+		return pLine;
+		}
+
+	// No index (out of memory).  Count lines from beginning of buffer.
+	pLine = pBuf->pFirstLine;
+	while(--lineNum > 0)
+		if((pLine = pLine->next) == NULL)
+			break;
+	return pLine;
+	}
+
 // This routine is called when a buffer is changed (edited) in any way.  It updates all of the required flags in the buffer and
 // windowing system.  The minimal flag(s) are passed as an argument; if the buffer is being displayed in more than one window,
-// we change WFEdit to WFHard.  Also WFMode is set if this is the first buffer change (the "*" has to be displayed) and any
-// user command/function preprocessing storage is freed.
+// we change WFEdit to WFHard.  Also WFMode is set if this is the first buffer change (the "*" has to be displayed), any user
+// command/function preprocessing storage is freed, and the change is noted in the buffer's edit journal.
 void bchange(Buffer *pBuf, ushort flags) {
 
 	if(pBuf->windCount > 1)			// Hard update needed?
@@ -46,6 +529,7 @@ void bchange(Buffer *pBuf, ushort flags) {
 		}
 	if(pBuf->pCallInfo != NULL)		// If precompiled user command or function...
 		preprocFree(pBuf);		// force preprocessor redo.
+	journalChange(pBuf);			// Disarm journal or flag it for a snapshot if change was not recorded.
 	supd_windFlags(pBuf, flags);		// Lastly, flag any windows displaying this buffer.
 	}
 
@@ -75,14 +559,40 @@ void llink(Line *pLine1, Buffer *pBuf, Line *pLine2) {
 
 		pLine1->prev = pLine0;
 		}
+	++pBuf->lineTotal;
+	pBuf->byteTotal += pLine1->used;
+	if(pBuf->lineIdx.blocks != NULL)
+		lxinsert(pBuf, pLine1);
 	}
 
-// Unlink a line from given buffer and free it.  If pBuf is NULL, use current buffer.  It is assumed that at least two lines
-// exist.
+// Link a detached list of lines (pFirstLine to pLastLine, containing lineCt lines and byteCt bytes of text) into given buffer
+// before line pLine2 in one step.  If pBuf is NULL, use current edit buffer.  The line index is discarded.
+void lsplice(Line *pFirstLine, Line *pLastLine, long lineCt, long byteCt, Buffer *pBuf, Line *pLine2) {
+
+	if(pBuf == NULL)
+		pBuf = sess.edit.pBuf;
+	lxfree(&pBuf->lineIdx);
+	pFirstLine->prev = pLine2->prev;
+	if(pLine2 == pBuf->pFirstLine)
+		pBuf->pFirstLine = pFirstLine;
+	else
+		pLine2->prev->next = pFirstLine;
+	pLastLine->next = pLine2;
+	pLine2->prev = pLastLine;
+	pBuf->lineTotal += lineCt;
+	pBuf->byteTotal += byteCt;
+	}
+
+// Unlink a line from given buffer and free it.  If pBuf is NULL, use current edit buffer.  It is assumed that at least two
+// lines exist.
 void lunlink(Line *pLine, Buffer *pBuf) {
 
 	if(pBuf == NULL)
-		pBuf = sess.cur.pBuf;
+		pBuf = sess.edit.pBuf;
+	--pBuf->lineTotal;
+	pBuf->byteTotal -= pLine->used;
+	if(pBuf->lineIdx.blocks != NULL)
+		lxremove(pBuf, pLine);
 	if(pLine == pBuf->pFirstLine)
 
 		// Deleting first line of buffer.
@@ -96,7 +606,7 @@ void lunlink(Line *pLine, Buffer *pBuf) {
 		pLine->next->prev = pLine->prev;
 		pLine->prev->next = pLine->next;
 		}
-	free((void *) pLine);
+	lrelease(pLine, pBuf);
 	}
 
 // Replace line pLine1 in given buffer with pLine2 and free pLine1.  If pBuf is NULL, use current edit buffer.
@@ -128,38 +638,10 @@ void lreplace1(Line *pLine1, Buffer *pBuf, Line *pLine2) {
 		else
 			pLine1->next->prev = pLine2;
 		}
-	free((void *) pLine1);
-	}
-
-// Replace lines pLine1 and pLine2 in the current edit buffer with pLine3 and free the first two.
-static void lreplace2(Line *pLine1, Line *pLine2, Line *pLine3) {
-
-	pLine3->next = pLine2->next;
-	if(pLine1 == sess.edit.pBuf->pFirstLine) {
-
-		// pLine1 is first line of buffer.
-		sess.edit.pBuf->pFirstLine = pLine3;
-		if(pLine2->next == NULL)
-
-			// pLine2 is last line of buffer.
-			pLine3->prev = pLine3;
-		else {
-			pLine3->prev = pLine1->prev;
-			pLine2->next->prev = pLine3;
-			}
-		}
-	else {
-		pLine1->prev->next = pLine3;
-		pLine3->prev = pLine1->prev;
-		if(pLine2->next == NULL)
-
-			// pLine2 is last line of buffer.
-			sess.edit.pBuf->pFirstLine->prev = pLine3;
-		else
-			pLine2->next->prev = pLine3;
-		}
-	free((void *) pLine1);
-	free((void *) pLine2);
+	pBuf->byteTotal += pLine2->used - pLine1->used;
+	if(pBuf->lineIdx.blocks != NULL)
+		lxreplace(pLine1, pLine2);
+	lrelease(pLine1, pBuf);
 	}
 
 // Fix "window face" line pointers and point offset after insert.
@@ -174,29 +656,16 @@ static void fixInsert(int offset, int n, Face *pFace, Line *pLine1, Line *pLine2
 		}
 	}
 
-// Scan all screens and windows and fix window pointers.
-void fixFace(int offset, int n, Line *pLine1, Line *pLine2) {
-	EScreen *pScrn;
-	EWindow *pWind;
-
-	// In all screens...
-	pScrn = sess.scrnHead;
-	do {
-		// In all windows...
-		pWind = pScrn->windHead;
-		do {
-			fixInsert(offset, n, &pWind->face, pLine1, pLine2);
-			} while((pWind = pWind->next) != NULL);
-		} while((pScrn = pScrn->next) != NULL);
-	}
-
-// Fix buffer pointers and marks after insert.
+// Fix window pointers, buffer pointers, and marks after insert into given buffer.  Only the windows and marks in the buffer's
+// registries are visited.
 void fixBufFace(Buffer *pBuf, int offset, int n, Line *pLine1, Line *pLine2) {
+	EWindow *pWind;
 	Mark *pMark;
 
+	for(pWind = pBuf->pWindHead; pWind != NULL; pWind = pWind->pNextBufWind)
+		fixInsert(offset, n, &pWind->face, pLine1, pLine2);
 	fixInsert(offset, n, &pBuf->face, pLine1, pLine2);
-	pMark = &pBuf->markHdr;
-	do {
+	for(pMark = lineMarks(pBuf, pLine1); pMark != NULL; pMark = pMark->pNextLineMark) {
 		if(pMark->point.pLine == pLine1) {
 			pMark->point.pLine = pLine2;
 
@@ -204,70 +673,83 @@ void fixBufFace(Buffer *pBuf, int offset, int n, Line *pLine1, Line *pLine2) {
 			// where they are set.  Hence, want to use '>' here instead of '>='.
 			if(pMark->point.offset > offset)
 				pMark->point.offset += n;
+			if(pLine2 != pLine1)
+				mregclear(pBuf);
 			}
-		} while((pMark = pMark->next) != NULL);
+		}
 	}
 
-// Insert "n" copies of the character "c" into the current edit buffer at point and return status.  In the easy case, all that
-// happens is the character(s) are stored in the line.  In the hard case, the line has to be reallocated.  After insertion, need
-// to (1), always update point in the current edit window if not NULL; and (2), update mark and point in other windows if their
-// buffer position is past the place where the insert was done.  Note that no validity checking is done, so if "c" is a newline,
-// it will be inserted as a literal character.
-int einsertc(int n, short c) {
-	char *str1, *str2;
+// Insert "n" characters into the current edit buffer at point and return status.  If "str" is not NULL, the characters are
+// copied from it; otherwise, "n" copies of the character "c" are inserted.  In the easy case, all that happens is the
+// character(s) are stored in the line.  In the hard case, the line has to be reallocated.  After insertion, need to (1), always
+// update point in the current edit window if not NULL; and (2), update mark and point in other windows if their buffer
+// position is past the place where the insert was done.  Note that no validity checking is done, so if "c" or "str" contains
+// a newline, it will be inserted as a literal character.  Long lines are given 50% headroom when reallocated (up to the
+// maximum line length of INT_MAX bytes) so that repeated inserts into them are amortized O(1).
+static int linsert(int n, short c, const char *str) {
+	char *str1;
 	Line *pLine1, *pLine2;
 	int offset;
-	int i;
-
-	// Don't allow if read-only buffer... and nothing to do if repeat count is zero.
-	if(allowEdit(true) != Success || n == 0)
-		return sess.rtn.status;
-
-	// Negative repeat count is an error.
-	if(n < 0)
-		return rsset(Failure, 0, text39, text137, n, 0);
-			// "%s (%d) must be %d or greater", "Repeat count"
+	long size;
 
-	// n > 0.  Get current line and determine the type of insert.
+	// Check new line length, record the insert in the buffer's journal, then get current line and determine the type of
+	// insert.
 	pLine1 = sess.edit.pFace->point.pLine;
+	if((size = (long) pLine1->used + n) > INT_MAX)
+		return rsset(Failure, 0, text515, size, INT_MAX);
+			// "Line too long (%ld bytes, maximum %d)"
+	if(journalEdit('C', &sess.edit.pFace->point, n, str, c) != Success)
+		return sess.rtn.status;
 	offset = sess.edit.pFace->point.offset;
-	if(pLine1->used + n > pLine1->size) {			// Not enough room left in line: reallocate.
-		if(lalloc(BlockSize(pLine1->used + n), &pLine2) != Success)
+	if(size > pLine1->size) {				// Not enough room left in line: reallocate.
+		if(size >= LongLineSize)
+			size += size >> 1;
+		if((size = BlockSize(size)) > INT_MAX)
+			size = INT_MAX;
+		if(lalloc((int) size, NULL, &pLine2) != Success)
 			return sess.rtn.status;			// Fatal error.
 		pLine2->used = pLine1->used + n;		// Set new "used" length.
-		str1 = pLine1->text;				// Copy old to new up to point.
-		str2 = pLine2->text;
-		while(str1 != pLine1->text + offset)
-			*str2++ = *str1++;
-		str2 += n;					// Make gap and copy remainder.
-		while(str1 != pLine1->text + pLine1->used)
-			*str2++ = *str1++;
+		memcpy(pLine2->text, pLine1->text, offset);	// Copy old to new up to point, then make gap and copy remainder.
+		memcpy(pLine2->text + offset + n, pLine1->text + offset, pLine1->used - offset);
 		lreplace1(pLine1, NULL, pLine2);		// Link in the new line and get rid of the old one.
 		}
 	else {							// Easy: update in place.
 		pLine2 = pLine1;				// Make gap in line for new character(s).
+		memmove(pLine2->text + offset + n, pLine2->text + offset, pLine2->used - offset);
 		pLine2->used += n;
-		str2 = pLine1->text + pLine1->used;
-		str1 = str2 - n;
-		while(str1 != pLine1->text + offset)
-			*--str2 = *--str1;
+		sess.edit.pBuf->byteTotal += n;
 		}
 	str1 = pLine2->text + offset;				// Store the new character(s) in the gap.
-	i = n;
-	do
-		*str1++ = c;
-		while(--i > 0);
+	if(str != NULL)
+		memcpy(str1, str, n);
+	else if(n == 1)
+		*str1 = c;
+	else
+		memset(str1, c, n);
 
 	// Set the "line change" flag in the current window and update face settings.  Note that pLine1 may have been freed by
 	// lreplace1(), but the pointer address is still valid for comparison purposes.
 	bchange(sess.edit.pBuf, WFEdit);
-	if(sess.edit.pScrn != NULL)
-		fixFace(offset, n, pLine1, pLine2);
 	fixBufFace(sess.edit.pBuf, offset, n, pLine1, pLine2);
 
 	return sess.rtn.status;
 	}
 
+// Insert "n" copies of the character "c" into the current edit buffer at point and return status.
+int einsertc(int n, short c) {
+
+	// Don't allow if read-only buffer... and nothing to do if repeat count is zero.
+	if(allowEdit(true) != Success || n == 0)
+		return sess.rtn.status;
+
+	// Negative repeat count is an error.
+	if(n < 0)
+		return rsset(Failure, 0, text39, text137, n, 0);
+			// "%s (%d) must be %d or greater", "Repeat count"
+
+	return linsert(n, c, NULL);
+	}
+
 // Fix "window face" line pointers and point offset after newline was inserted.
 static void fixInsertNL(int offset, Face *pFace, Line *pLine1, Line *pLine2) {
 
@@ -287,17 +769,17 @@ int einsertNL(void) {
 	char *str1, *str2;
 	Line *pLine1, *pLine2;
 	int offset;
-	EScreen *pScrn;
 	EWindow *pWind;
 	Mark *pMark;
 
-	if(allowEdit(true) != Success)			// Don't allow if read-only buffer.
+	if(allowEdit(true) != Success ||		// Don't allow if read-only buffer.
+	 journalEdit('I', &sess.edit.pFace->point, 1, "\n", 0) != Success)
 		return sess.rtn.status;
 
 	bchange(sess.edit.pBuf, WFHard);
 	pLine1 = sess.edit.pFace->point.pLine;		// Get line pointer and offset of point.
 	offset = sess.edit.pFace->point.offset;
-	if(lalloc(offset, &pLine2) != Success)		// New first half line.
+	if(lalloc(offset, NULL, &pLine2) != Success)		// New first half line.
 		return sess.rtn.status;			// Fatal error.
 	str1 = pLine1->text;				// Shuffle text around.
 	str2 = pLine2->text;
@@ -307,32 +789,25 @@ int einsertNL(void) {
 	while(str1 != pLine1->text + pLine1->used)
 		*str2++ = *str1++;
 	pLine1->used -= offset;
+	sess.edit.pBuf->byteTotal -= offset;
 	llink(pLine2, NULL, pLine1);
 
-	if(sess.edit.pScrn != NULL) {
-
-		// In all screens...
-		pScrn = sess.scrnHead;
-		do {
-			// In all windows...
-			pWind = pScrn->windHead;
-			do {
-				fixInsertNL(offset, &pWind->face, pLine1, pLine2);
-				} while((pWind = pWind->next) != NULL);
-			} while((pScrn = pScrn->next) != NULL);
-		}
+	// In all windows displaying buffer...
+	for(pWind = sess.edit.pBuf->pWindHead; pWind != NULL; pWind = pWind->pNextBufWind)
+		fixInsertNL(offset, &pWind->face, pLine1, pLine2);
 
 	// In current buffer...
 	fixInsertNL(offset, &sess.edit.pBuf->face, pLine1, pLine2);
-	pMark = &sess.edit.pBuf->markHdr;
-	do {
+	for(pMark = lineMarks(sess.edit.pBuf, pLine1); pMark != NULL; pMark = pMark->pNextLineMark) {
 		if(pMark->point.pLine == pLine1) {
-			if(pMark->point.offset < offset)
+			if(pMark->point.offset < offset) {
 				pMark->point.pLine = pLine2;
+				mregclear(sess.edit.pBuf);
+				}
 			else
 				pMark->point.offset -= offset;
 			}
-		} while((pMark = pMark->next) != NULL);
+		}
 
 #if MMDebug & Debug_Narrow
 	dumpBuffer("einsertNL(): AFTER", NULL, true);
@@ -340,134 +815,108 @@ int einsertNL(void) {
 	return sess.rtn.status;
 	}
 
-// Insert a string at point.  "str" may be NULL.
-int einserts(const char *str) {
+// Fix "window face" line pointers and point offset after a block of text containing newlines was inserted at given offset in
+// line pLine1.  pFirstLine is the new line holding the text before the insertion point and pLastLine is the line (pLine1 or
+// its replacement) holding the last text segment of length lastLen followed by the text after the insertion point.
+static void fixInsertBlk(int offset, int lastLen, Face *pFace, Line *pLine1, Line *pFirstLine, Line *pLastLine) {
 
-	if(str != NULL) {
-		while(*str != '\0') {
-			if(((*str == '\n') ? einsertNL() : einsertc(1, *str)) != Success)
-				break;
-			++str;
+	if(pFace->pTopLine == pLine1)
+		pFace->pTopLine = pFirstLine;
+	if(pFace->point.pLine == pLine1) {
+		if(pFace->point.offset < offset)
+			pFace->point.pLine = pFirstLine;
+		else {
+			pFace->point.pLine = pLastLine;
+			pFace->point.offset += lastLen - offset;
 			}
 		}
-	return sess.rtn.status;
-	}
-
-// Fix "window face" line pointers and point offset after a newline was deleted without line reallocation.
-static void fixDelNL1(Face *pFace, Line *pLine1, Line *pLine2) {
-
-	if(pFace->pTopLine == pLine2)
-		pFace->pTopLine = pLine1;
-	if(pFace->point.pLine == pLine2) {
-		pFace->point.pLine = pLine1;
-		pFace->point.offset += pLine1->used;
-		}
 	}
 
-// Fix "window face" line pointers and point offset after a newline was deleted and a new line was allocated.
-static void fixDelNL2(Face *pFace, Line *pLine1, Line *pLine2, Line *pLine3) {
-
-	if(pFace->pTopLine == pLine1 || pFace->pTopLine == pLine2)
-		pFace->pTopLine = pLine3;
-	if(pFace->point.pLine == pLine1)
-		pFace->point.pLine = pLine3;
-	else if(pFace->point.pLine == pLine2) {
-		pFace->point.pLine = pLine3;
-		pFace->point.offset += pLine1->used;
-		}
-	}
-
-// Delete a newline from current edit buffer -- join the current line with the next line.  Easy cases can be done by shuffling
-// data around.  Hard cases require that lines be moved about in memory.  Called by edelc() only.  It is assumed that there will
-// always be at least two lines in the current buffer when this routine is called and the current line will never be the last
-// line of the buffer (which does not have a newline delimiter).
-static int edelNL(void) {
-	char *str1, *str2;
-	Line *pLine1, *pLine2, *pLine3;
-	EScreen *pScrn;
+// Insert a block of text of given length into the current edit buffer at point and return status.  Newlines in the text
+// split the point line unless literalNL is true, in which case they are inserted as literal characters.  Each new line is
+// allocated once at its final size and linked in, after which window faces and marks are fixed in a single pass.
+int einsertBlk(const char *str, int len, bool literalNL) {
+	const char *str1, *strEnd;
+	Line *pLine1, *pLine2, *pFirstLine;
+	int offset, lastLen, used;
 	EWindow *pWind;
 	Mark *pMark;
 
-	pLine1 = sess.edit.pFace->point.pLine;
-	pLine2 = pLine1->next;
-
-	// Do simple join if room in current line for next line.
-	if(pLine2->used <= pLine1->size - pLine1->used) {
-		str1 = pLine1->text + pLine1->used;
-		str2 = pLine2->text;
-		while(str2 != pLine2->text + pLine2->used)
-			*str1++ = *str2++;
-
-		if(sess.edit.pScrn != NULL) {
-
-			// In all screens...
-			pScrn = sess.scrnHead;
-			do {
-				// In all windows...
-				pWind = pScrn->windHead;
-				do {
-					fixDelNL1(&pWind->face, pLine1, pLine2);
-					} while((pWind = pWind->next) != NULL);
-				} while((pScrn = pScrn->next) != NULL);
-			}
-
-		// In current buffer...
-		fixDelNL1(&sess.edit.pBuf->face, pLine1, pLine2);
-		pMark = &sess.edit.pBuf->markHdr;
-		do {
-			if(pMark->point.pLine == pLine2) {
-				pMark->point.pLine = pLine1;
-				pMark->point.offset += pLine1->used;
-				}
-			} while((pMark = pMark->next) != NULL);
-
-		pLine1->used += pLine2->used;
-		lunlink(pLine2, NULL);
+	// Don't allow if read-only buffer... and nothing to do if no text.
+	if(allowEdit(true) != Success || len == 0)
 		return sess.rtn.status;
-		}
-
-	// Simple join not possible, get more space.
-	if(lalloc(pLine1->used + pLine2->used, &pLine3) != Success)
-		return sess.rtn.status;	// Fatal error.
-	str1 = pLine1->text;
-	str2 = pLine3->text;
-	while(str1 != pLine1->text + pLine1->used)
-		*str2++ = *str1++;
-	str1 = pLine2->text;
-	while(str1 != pLine2->text + pLine2->used)
-		*str2++ = *str1++;
 
-	// Replace pLine1 and pLine2 with pLine3.
-	lreplace2(pLine1, pLine2, pLine3);
+	// If no newlines to process, do a simple insert.
+	if(literalNL || (str1 = memchr(str, '\n', len)) == NULL)
+		return linsert(len, 0, str);
 
-	if(sess.edit.pScrn != NULL) {
+	if(journalEdit('I', &sess.edit.pFace->point, len, str, 0) != Success)
+		return sess.rtn.status;
+	bchange(sess.edit.pBuf, WFHard);
+	pLine1 = sess.edit.pFace->point.pLine;		// Get line pointer and offset of point.
+	offset = sess.edit.pFace->point.offset;
+	strEnd = str + len;
 
-		// In all screens...
-		pScrn = sess.scrnHead;
-		do {
-			// In all windows...
-			pWind = pScrn->windHead;
-			do {
-				fixDelNL2(&pWind->face, pLine1, pLine2, pLine3);
-				} while((pWind = pWind->next) != NULL);
-			} while((pScrn = pScrn->next) != NULL);
+	// Create first line from text before point followed by first text segment, and link it in before the point line.
+	if(lalloc(offset + (str1 - str), NULL, &pFirstLine) != Success)
+		return sess.rtn.status;			// Fatal error.
+	memcpy(pFirstLine->text, pLine1->text, offset);
+	memcpy(pFirstLine->text + offset, str, str1 - str);
+	llink(pFirstLine, NULL, pLine1);
+
+	// Create a line for each remaining text segment that ends with a newline.
+	while((str1 = memchr(str = str1 + 1, '\n', strEnd - str1 - 1)) != NULL) {
+		if(lalloc(str1 - str, NULL, &pLine2) != Success)
+			return sess.rtn.status;		// Fatal error.
+		memcpy(pLine2->text, str, str1 - str);
+		llink(pLine2, NULL, pLine1);
+		}
+
+	// Replace text before point in point line with last text segment, reallocating line if needed.
+	lastLen = strEnd - str;
+	used = lastLen + pLine1->used - offset;
+	if(used <= pLine1->size) {
+		pLine2 = pLine1;
+		memmove(pLine2->text + lastLen, pLine2->text + offset, pLine2->used - offset);
+		sess.edit.pBuf->byteTotal += used - pLine2->used;
+		pLine2->used = used;
+		}
+	else {
+		if(lalloc(used, NULL, &pLine2) != Success)
+			return sess.rtn.status;		// Fatal error.
+		memcpy(pLine2->text + lastLen, pLine1->text + offset, pLine1->used - offset);
+		lreplace1(pLine1, NULL, pLine2);
 		}
+	memcpy(pLine2->text, str, lastLen);
 
-	// In current buffer...
-	fixDelNL2(&sess.edit.pBuf->face, pLine1, pLine2, pLine3);
-	pMark = &sess.edit.pBuf->markHdr;
-	do {
-		if(pMark->point.pLine == pLine1)
-			pMark->point.pLine = pLine3;
-		else if(pMark->point.pLine == pLine2) {
-			pMark->point.pLine = pLine3;
-			pMark->point.offset += pLine1->used;
+	// Fix window faces and marks.  Note that pLine1 may have been freed by lreplace1(), but the pointer address is still
+	// valid for comparison purposes.
+	for(pWind = sess.edit.pBuf->pWindHead; pWind != NULL; pWind = pWind->pNextBufWind)
+		fixInsertBlk(offset, lastLen, &pWind->face, pLine1, pFirstLine, pLine2);
+
+	// In current buffer...  Note that marks are anchored and not pushed forward by the insertion.
+	fixInsertBlk(offset, lastLen, &sess.edit.pBuf->face, pLine1, pFirstLine, pLine2);
+	for(pMark = lineMarks(sess.edit.pBuf, pLine1); pMark != NULL; pMark = pMark->pNextLineMark) {
+		if(pMark->point.pLine == pLine1) {
+			if(pMark->point.offset <= offset)
+				pMark->point.pLine = pFirstLine;
+			else {
+				pMark->point.pLine = pLine2;
+				pMark->point.offset += lastLen - offset;
+				}
+			mregclear(sess.edit.pBuf);
 			}
-		} while((pMark = pMark->next) != NULL);
+		}
 
 	return sess.rtn.status;
 	}
 
+// Insert a string at point.  "str" may be NULL.
+int einserts(const char *str) {
+
+	return (str == NULL) ? sess.rtn.status : einsertBlk(str, strlen(str), false);
+	}
+
 // Fix point offset after delete.
 static void fixDotDel1(int offset, int chunk, Point *pPoint) {
 	int delta;
@@ -486,168 +935,251 @@ static void fixDotDel1(int offset, int chunk, Point *pPoint) {
 
 // Fix point after delete in other windows with the same text displayed.
 static void fixDotDel(Line *pLine, int offset, int chunk) {
-	EScreen *pScrn;
 	EWindow *pWind;
 	Mark *pMark;
 
-	if(sess.edit.pScrn != NULL) {
-
-		// In all screens...
-		pScrn = sess.scrnHead;
-		do {
-			// In all windows...
-			pWind = pScrn->windHead;
-			do {
-				if(pWind->face.point.pLine == pLine)
-					fixDotDel1(offset, chunk, &pWind->face.point);
-				} while((pWind = pWind->next) != NULL);
-			} while((pScrn = pScrn->next) != NULL);
-		}
+	// In all windows displaying buffer...
+	for(pWind = sess.edit.pBuf->pWindHead; pWind != NULL; pWind = pWind->pNextBufWind)
+		if(pWind->face.point.pLine == pLine)
+			fixDotDel1(offset, chunk, &pWind->face.point);
 
 	// In current buffer...
 	if(sess.edit.pBuf->face.point.pLine == pLine)
 		fixDotDel1(offset, chunk, &sess.edit.pBuf->face.point);
-	pMark = &sess.edit.pBuf->markHdr;
-	do {
+	for(pMark = lineMarks(sess.edit.pBuf, pLine); pMark != NULL; pMark = pMark->pNextLineMark)
 		if(pMark->point.pLine == pLine)
 			fixDotDel1(offset, chunk, &pMark->point);
+	}
+
+// Fix a point after a deletion spanning lines pLine1 (at offset1) through pLine2 (at offset2) in the current edit buffer.
+// Interior lines of the deletion have been flagged with a negative "used" length, and pLine3 is the line that holds the joined
+// text.
+static void fixDelBlk1(Point *pPoint, Line *pLine1, int offset1, Line *pLine2, int offset2, Line *pLine3) {
+
+	if(pPoint->pLine == pLine1) {
+		pPoint->pLine = pLine3;
+		if(pPoint->offset > offset1)
+			pPoint->offset = offset1;
+		}
+	else if(pPoint->pLine == pLine2) {
+		pPoint->pLine = pLine3;
+		pPoint->offset = (pPoint->offset <= offset2) ? offset1 : offset1 + pPoint->offset - offset2;
+		}
+	else if(pPoint->pLine->used < 0) {
+		pPoint->pLine = pLine3;
+		pPoint->offset = offset1;
+		}
+	}
+
+// Fix "window face" line pointers and point offset after a deletion spanning lines pLine1 (at offset1) through pLine2 (at
+// offset2), as for fixDelBlk1().
+static void fixDelBlk(Face *pFace, Line *pLine1, int offset1, Line *pLine2, int offset2, Line *pLine3) {
+
+	if(pFace->pTopLine == pLine1 || pFace->pTopLine == pLine2 || pFace->pTopLine->used < 0)
+		pFace->pTopLine = pLine3;
+	fixDelBlk1(&pFace->point, pLine1, offset1, pLine2, offset2, pLine3);
+	}
+
+// Delete text in the current edit buffer from pLine1 (at offset1) through pLine2 (at offset2), where pLine2 follows pLine1.
+// The deleted text is saved to given fabrication object if not NULL (prepended if "prepend" is true, otherwise appended).  The
+// interior lines and pLine2 are unlinked as a sub-list and freed, only the two boundary lines are joined, and window faces
+// and marks are fixed in one pass.  Return status.
+static int edelBlk(Line *pLine1, int offset1, Line *pLine2, int offset2, DFab *pFab, bool prepend) {
+	Line *pLine, *pLine3, *pNextLine;
+	int used;
+	EWindow *pWind;
+	Mark *pMark;
+	Buffer *pBuf = sess.edit.pBuf;
+
+	// Get line for joined text, reallocating first boundary line if needed.
+	if((used = offset1 + pLine2->used - offset2) <= pLine1->size)
+		pLine3 = pLine1;
+	else {
+		if(lalloc(used, NULL, &pLine3) != Success)
+			return sess.rtn.status;	// Fatal error.
+		memcpy(pLine3->text, pLine1->text, offset1);
+		}
+
+	// Save the text to the kill or delete ring.
+	if(pFab != NULL) {
+		if(!prepend) {
+			if(pLine1->used > offset1 && dputmem((void *) (pLine1->text + offset1), pLine1->used - offset1, pFab, 0) != 0)
+				goto LibFail;
+			for(pLine = pLine1->next; pLine != pLine2; pLine = pLine->next)
+				if(dputc('\n', pFab, 0) != 0 ||
+				 (pLine->used > 0 && dputmem((void *) pLine->text, pLine->used, pFab, 0) != 0))
+					goto LibFail;
+			if(dputc('\n', pFab, 0) != 0 || (offset2 > 0 && dputmem((void *) pLine2->text, offset2, pFab, 0) != 0))
+				goto LibFail;
+			}
+		else {
+			if(offset2 > 0 && dputmem((void *) pLine2->text, offset2, pFab, 0) != 0)
+				goto LibFail;
+			for(pLine = pLine2->prev; pLine != pLine1; pLine = pLine->prev)
+				if(dputc('\n', pFab, 0) != 0 ||
+				 (pLine->used > 0 && dputmem((void *) pLine->text, pLine->used, pFab, 0) != 0))
+					goto LibFail;
+			if(dputc('\n', pFab, 0) != 0 || (pLine1->used > offset1 &&
+			 dputmem((void *) (pLine1->text + offset1), pLine1->used - offset1, pFab, 0) != 0))
+				goto LibFail;
+			}
+		}
+
+	// Join the remainder of the second boundary line to the first and update the buffer totals.
+	memcpy(pLine3->text + offset1, pLine2->text + offset2, pLine2->used - offset2);
+	if(pLine3 == pLine1) {
+		pBuf->byteTotal += used - pLine1->used;
+		pLine1->used = used;
+		}
+	pLine = pLine1;
+	do {
+		pLine = pLine->next;
+		--pBuf->lineTotal;
+		pBuf->byteTotal -= pLine->used;
+		} while(pLine != pLine2);
+
+	// Flag the interior lines so that window faces and marks on them can be found, then fix the latter.
+	for(pLine = pLine1->next; pLine != pLine2; pLine = pLine->next)
+		pLine->used = -1;
+	for(pWind = pBuf->pWindHead; pWind != NULL; pWind = pWind->pNextBufWind)
+		fixDelBlk(&pWind->face, pLine1, offset1, pLine2, offset2, pLine3);
+
+	// In current buffer...  All marks are checked because any number of lines may be involved.
+	fixDelBlk(&pBuf->face, pLine1, offset1, pLine2, offset2, pLine3);
+	pMark = &pBuf->markHdr;
+	do {
+		fixDelBlk1(&pMark->point, pLine1, offset1, pLine2, offset2, pLine3);
 		} while((pMark = pMark->next) != NULL);
+	mregclear(pBuf);
+
+	// Remove the interior lines and second boundary line from the line index, unlink them as a sub-list, and free them.
+	lxremoveBlk(pBuf, pLine1, pLine2);
+	pNextLine = pLine2->next;
+	pLine2->next = NULL;
+	pLine = pLine1->next;
+	if((pLine1->next = pNextLine) == NULL)
+		pBuf->pFirstLine->prev = pLine1;
+	else
+		pNextLine->prev = pLine1;
+	do {
+		pNextLine = pLine->next;
+		lrelease(pLine, pBuf);
+		} while((pLine = pNextLine) != NULL);
+
+	// Replace first boundary line with the new one if it was reallocated.
+	if(pLine3 != pLine1)
+		lreplace1(pLine1, pBuf, pLine3);
+
+	return sess.rtn.status;
+LibFail:
+	if(pLine3 != pLine1)
+		lrelease(pLine3, pBuf);
+	return libfail();
 	}
 
 // This function deletes up to n characters from the current edit buffer, starting at point.  The text that is deleted may
 // include newlines.  Positive n deletes forward; negative n deletes backward.  Returns current status if all of the characters
 // were deleted, NotFound (bypassing rsset()) if they were not (because point ran into a buffer boundary), or the appropriate
 // status if an error occurred.  The deleted text is put in the kill ring if the EditKill flag is set, the delete ring if the
-// EditDel flag is set, otherwise discarded.
+// EditDel flag is set, otherwise discarded.  Deletions that span lines are done in one step by edelBlk().
 int edelc(long n, ushort flags) {
 
 	if(n == 0 || allowEdit(true) != Success)	// Don't allow if read-only buffer.
 		return sess.rtn.status;
 
-	ushort windFlags;
-	char *str1, *str2;
-	Line *pLine;
-	int offset, chunk;
+	ushort windFlags = 0;
+	char *str;
+	Line *pLine1, *pLine2;
+	int offset1, offset2, chunk;
+	long count;
 	RingEntry *pEntry;
 	DFab fab;
 	Point *pPoint = &sess.edit.pFace->point;
 	bool hitEOB = false;
 
-	// Set kill buffer pointer.
-	pEntry = (flags & EditKill) ? ringTable[RingIdxKill].pEntry : (flags & EditDel) ? ringTable[RingIdxDel].pEntry : NULL;
-	windFlags = 0;
-
-	// Going forward?
+	// Find the limits of the deletion: pLine1 and offset1 (beginning) to pLine2 and offset2 (end).
+	pLine1 = pLine2 = pPoint->pLine;
 	if(n > 0) {
-		if(pEntry != NULL && dopenwith(&fab, &pEntry->data, FabAppend) != 0)
-			goto LibFail;
-		do {
-			// Get the current line.
-			pLine = pPoint->pLine;
-			offset = pPoint->offset;
-
-			// Figure out how many characters to delete on this line.
-			if((chunk = pLine->used - offset) > n)
-				chunk = n;
-
-			// If at the end of a line, merge with the next.
-			if(chunk == 0) {
-
-				// Can't delete past end of buffer.
-				if(pLine->next == NULL)
-					goto EOB;
+		offset1 = pPoint->offset;
+		count = offset1 + n;
+		while(count > pLine2->used) {
 
-				// Flag that we are making a hard change and delete newline.
-				windFlags |= WFHard;
-				if(edelNL() != Success)
-					return sess.rtn.status;
-				if(pEntry != NULL && dputc('\n', &fab, 0) != 0)
-					goto LibFail;
-				--n;
-				continue;
+			// Can't delete past end of buffer.
+			if(pLine2->next == NULL) {
+				hitEOB = true;
+				count = pLine2->used;
+				break;
 				}
-
-			// Flag the fact we are changing the current line.
-			windFlags |= WFEdit;
-
-			// Find the limits of the kill.
-			str1 = pLine->text + offset;
-			str2 = str1 + chunk;
-
-			// Save the text to the kill buffer.
-			if(pEntry != NULL && chunk > 0 && dputmem((void *) str1, chunk, &fab, 0) != 0)
-				goto LibFail;
-
-			// Shift what remains on the line leftward.
-			while(str2 < pLine->text + pLine->used)
-				*str1++ = *str2++;
-			pLine->used -= chunk;
-
-			// Fix any other windows with the same text displayed.
-			fixDotDel(pLine, offset, chunk);
-
-			// We have deleted "chunk" characters.  Update counter.
-			n -= chunk;
-			} while(n > 0);
+			count -= pLine2->used + 1;
+			pLine2 = pLine2->next;
+			}
+		offset2 = count;
 		}
 	else {
-		if(pEntry != NULL && dopenwith(&fab, &pEntry->data, FabPrepend) != 0)
-			goto LibFail;
-		do {
-			// Get the current line.
-			pLine = pPoint->pLine;
-			offset = pPoint->offset;
-
-			// Figure out how many characters to delete on this line.
-			if((chunk = offset) > -n)
-				chunk = -n;
+		offset2 = pPoint->offset;
+		count = offset2 + n;
+		while(count < 0) {
+
+			// Can't delete past beginning of buffer.
+			if(pLine1 == sess.edit.pBuf->pFirstLine) {
+				hitEOB = true;
+				count = 0;
+				break;
+				}
+			pLine1 = pLine1->prev;
+			count += pLine1->used + 1;
+			}
+		offset1 = count;
+		}
 
-			// If at the beginning of a line, merge with the previous one.
-			if(chunk == 0) {
+	// Record the deletion in the buffer's journal, counting each line break as one character.
+	if(pLine1 != pLine2 || offset2 > offset1) {
+		Point point = {pLine1, offset1};
+		Line *pLine = pLine1;
 
-				// Can't delete past beginning of buffer.
-				if(pLine == sess.edit.pBuf->pFirstLine)
-					goto EOB;
+		for(count = offset2 - offset1; pLine != pLine2; pLine = pLine->next)
+			count += pLine->used + 1;
+		if(journalEdit('D', &point, count, NULL, 0) != Success)
+			return sess.rtn.status;
+		}
 
-				// Flag that we are making a hard change and delete the newline.
-				windFlags |= WFHard;
-				(void) moveChar(-1);
-				if(edelNL() != Success)
-					return sess.rtn.status;
-				if(pEntry != NULL && dputc('\n', &fab, 0) != 0)
-					goto LibFail;
-				++n;
-				continue;
-				}
+	// Set kill buffer pointer.
+	pEntry = (flags & EditKill) ? ringTable[RingIdxKill].pEntry : (flags & EditDel) ? ringTable[RingIdxDel].pEntry : NULL;
+	if(pEntry != NULL && dopenwith(&fab, &pEntry->data, n > 0 ? FabAppend : FabPrepend) != 0)
+		goto LibFail;
 
-			// Flag the fact we are changing the current line.
-			windFlags |= WFEdit;
+	// Delete the text.
+	if(pLine1 != pLine2) {
 
-			// Find the limits of the kill.
-			str1 = pLine->text + offset;
-			str2 = str1 - chunk;
+		// Deletion spans lines.  Flag that we are making a hard change.
+		windFlags = WFHard;
+		if(edelBlk(pLine1, offset1, pLine2, offset2, pEntry != NULL ? &fab : NULL, n < 0) != Success)
+			return sess.rtn.status;
+		}
+	else if((chunk = offset2 - offset1) > 0) {
 
-			// Save the text to the kill buffer.
-			if(pEntry != NULL && dputmem((void *) str2, chunk, &fab, 0) != 0)
-				goto LibFail;
+		// Flag the fact we are changing the current line.
+		windFlags = WFEdit;
 
-			// Shift what remains on the line leftward.
-			while(str1 < pLine->text + pLine->used)
-				*str2++ = *str1++;
-			pLine->used -= chunk;
-			pPoint->offset -= chunk;
+		// Save the text to the kill buffer.
+		str = pLine1->text + offset1;
+		if(pEntry != NULL && dputmem((void *) str, chunk, &fab, 0) != 0)
+			goto LibFail;
 
-			// Fix any other windows with the same text displayed.
-			fixDotDel(pLine, offset, -chunk);
+		// Shift what remains on the line leftward.
+		memmove(str, str + chunk, pLine1->text + pLine1->used - str - chunk);
+		pLine1->used -= chunk;
+		sess.edit.pBuf->byteTotal -= chunk;
 
-			// We have deleted "chunk" characters.  Update counter.
-			n += chunk;
-			} while(n < 0);
+		// Fix any other windows with the same text displayed.
+		if(n > 0)
+			fixDotDel(pLine1, offset1, chunk);
+		else {
+			pPoint->offset -= chunk;
+			fixDotDel(pLine1, offset2, -chunk);
+			}
 		}
-	goto Retn;
-EOB:
-	hitEOB = true;
-Retn:
+
 	if(pEntry != NULL && dclose(&fab, FabStr) != 0)
 		goto LibFail;
 	if(windFlags)
@@ -1044,6 +1576,7 @@ static int ltrim(void) {
 		}
 	if((len = str - pLine->text) == pLine->used)
 		return 0;
+	sess.cur.pBuf->byteTotal -= pLine->used - len;
 	pLine->used = len;
 	return 1;
 	}
@@ -1610,6 +2143,25 @@ static void lswap(Buffer *pBuf, Line *pLine1, Line *pLine2) {
 	Line *prev1 = pLine1->prev;
 	Line *next2 = pLine2->next;
 
+	// Swap block membership in line index, if it exists (line counts do not change).
+	if(pBuf->lineIdx.blocks != NULL) {
+		LineBlk *pBlk1 = pLine1->pBlk;
+		LineBlk *pBlk2 = pLine2->pBlk;
+
+		if(pBlk1 == pBlk2) {
+			if(pBlk1->pFirstLine == pLine1)
+				pBlk1->pFirstLine = pLine2;
+			}
+		else {
+			// pLine1 is last line of pBlk1 and pLine2 is first line of pBlk2.  pLine1 may also be the first (only)
+			// line of pBlk1.
+			pLine1->pBlk = pBlk2;
+			pLine2->pBlk = pBlk1;
+			if(pBlk1->pFirstLine == pLine1)
+				pBlk1->pFirstLine = pLine2;
+			pBlk2->pFirstLine = pLine1;
+			}
+		}
 	pLine1->next = pLine2->next;
 	pLine1->prev = pLine2;
 	pLine2->next = pLine1;
@@ -1746,7 +2298,8 @@ MovePt:
 		// Sort the array.
 		lsort((const Line **) ppLine0, 0, n - 1, flags);
 
-		// Relink the lines in the block to each other.
+		// Relink the lines in the block to each other (which invalidates the line index).
+		lxfree(&pBuf->lineIdx);
 		ppLine = ppLine0;
 		pLine0 = *ppLine++;
 		do {
@@ -1680,7 +1680,7 @@ Salt0:
 				}
 Salt1:
 			// Allocate the space for the line.
-			if(lalloc(len, &pLine) != Success)
+			if(lalloc(len, pCallBuf, &pLine) != Success)
 				return sess.rtn.status;
 
 			// Copy the text into the new line.
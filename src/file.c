@@ -51,16 +51,96 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/uio.h>
+#include <sys/mman.h>
+#include <signal.h>
 #include <errno.h>
 #include <glob.h>
+#include <pthread.h>
+#include <time.h>
+#include <zlib.h>
+#if LINUX
+#include <sys/inotify.h>
+#endif
 #include "cmd.h"
+#include "bind.h"
 #include "exec.h"
 
 // Make selected global definitions local.
 #define FileData
 #include "file.h"
 
+// Compression state of an output stream that is writing a gzip file.
+typedef struct {
+	z_stream strm;			// zlib stream.
+	Bytef buf[FIFileBufSize];	// Compressed output.
+	} Deflater;
+
+// Output stream, which gathers line text and delimiters for writev() (see f_write()).  Streams do not use any global state so
+// that buffers can be written concurrently by worker threads.
+typedef struct {
+	int fileHandle;			// Output file descriptor.
+	bool retry;			// Retry writes that fail with EAGAIN (pipe).
+	char *bufCur, *bufEnd;		// Free space in staging buffer.
+	int vecCt;			// Number of entries in vec.
+	off_t count;			// Number of bytes written.
+	int errNum;			// Error number of failed write, or zero if none.
+	Deflater *pDeflater;		// Compression state if output is compressed, otherwise NULL.
+	struct iovec vec[FIOtpVecMax];	// Pending output.
+	char buf[FIFileBufSize];	// Staging buffer for short strings.
+	} OtpStream;
+
+// Line-difference control object, used by reloadBuf() to compare a buffer's lines (a) with the lines of its file (b).
+typedef struct {
+	struct DiffLine {
+		Line *pLine;		// Line.
+		ulong hash;		// Hash of line text.
+		} *a, *b;
+	long aCt, bCt;			// Number of lines in each array.
+	char *buf;			// Work buffer for text of a change (on heap).
+	size_t bufSize;			// Size of work buffer.
+	uint changeCt;			// Number of changes applied.
+	} DiffCtrl;
+
+// Decompression state of a gzip input file.  Blocks of decompressed data are produced by a separate thread (see f_inflate()) and
+// queued in a ring, so that decompression of the next blocks overlaps the scanning of lines in the current one by f_getline().
+typedef struct Inflater {
+	z_stream strm;			// zlib stream.
+	int fileHandle;			// Compressed input file.
+	bool threaded;			// Producer thread is running (otherwise, blocks are decompressed on demand by f_zread()).
+	pthread_t thread;		// Producer thread.
+	pthread_mutex_t mutex;		// Guards block counts and flags.
+	pthread_cond_t cond;		// Signaled when a block is filled or released.
+	uint freeCt, readyCt;		// Number of empty and filled blocks.
+	uint fillIdx, readIdx;		// Next block to fill and to read.
+	bool held;			// Block at readIdx is in use by consumer.
+	bool done;			// Producer hit EOF or an error.
+	bool stop;			// Consumer is shutting down.
+	int errNum;			// Error number of failed read, -1 if data is corrupt, or zero if none.
+	uint memberCt;			// Number of gzip members decompressed.
+	size_t blockLen[FIZBlocks];	// Number of bytes in each block.
+	Bytef inBuf[FIFileBufSize];	// Compressed input.
+	char blocks[FIZBlocks][FIFileBufSize];	// Decompressed data.
+	} Inflater;
+
 static const char stdinFilename[] = "<stdin>";
+static OtpStream otpStream;		// Output stream used by main thread.
+static int followFd = -1;		// inotify instance used for follow mode, or -1 if none.
+static int followCount = 0;		// Number of buffers being followed.
+static off_t otpCount;			// Number of bytes written to output file.
+static double otpTime;			// Elapsed time of last write in seconds.
+static pthread_mutex_t saveMutex = PTHREAD_MUTEX_INITIALIZER;	// Guards SaveCtrl.nextJob in worker threads.
+static SyncSave *syncSaves = NULL;	// Pending durable saves (array on heap).
+static int syncSaveCt = 0;		// Number of pending durable saves.
+static int syncSaveMax = 0;		// Allocated size of syncSaves array.
+static volatile sig_atomic_t mapFault = 0;	// Mapped input file was truncated while being read.
+static struct sigaction oldBusAction;	// SIGBUS action in effect before input file was mapped.
+static bool syncDefer = false;		// Defer completion of durable saves until f_syncAll() is called by saveBufs().
+
+#if LINUX
+#define fdsync(fileHandle)	fdatasync(fileHandle)
+#else
+#define fdsync(fileHandle)	fsync(fileHandle)
+#endif
 
 // Copy glob() results to a new array.  Return status.
 static int globtoa(Datum *pRtnVal, glob_t *pGlob) {
@@ -233,13 +313,209 @@ static void saveFilename(const char *filename) {
 	fileInfo.filename = (filename == NULL) ? stdinFilename : filename;
 	}
 
-// Free input line buffer.
+// Decompress next block of input into given block of given Inflater object.  Concatenated gzip members are decompressed in
+// sequence and trailing garbage after the last one is ignored, as gzip does.  Return zero if more data may follow, 1 if end of
+// file was reached, or -1 if an error occurred (with error number saved in object).
+static int f_zblock(Inflater *pInf, uint idx) {
+	ssize_t n;
+	int status;
+	int rtn = 0;
+	z_stream *pStrm = &pInf->strm;
+
+	pStrm->next_out = (Bytef *) pInf->blocks[idx];
+	pStrm->avail_out = FIFileBufSize;
+	do {
+		// Input exhausted?  If so, read more.
+		if(pStrm->avail_in == 0) {
+			if((n = read(pInf->fileHandle, pInf->inBuf, FIFileBufSize)) == -1) {
+				if(errno == EINTR)
+					continue;
+				pInf->errNum = errno;
+				goto Fail;
+				}
+			if(n == 0) {
+
+				// Hit EOF.  Data is truncated if in the middle of a member.
+				if(pStrm->total_in > 0)
+					goto Corrupt;
+				rtn = 1;
+				break;
+				}
+			pStrm->next_in = pInf->inBuf;
+			pStrm->avail_in = n;
+			}
+
+		// Decompress.
+		if((status = inflate(pStrm, Z_NO_FLUSH)) == Z_STREAM_END) {
+			++pInf->memberCt;
+			(void) inflateReset(pStrm);
+			}
+		else if(status == Z_DATA_ERROR && pInf->memberCt > 0 && pStrm->total_out == 0) {
+
+			// Not a gzip header following a member: ignore rest of file.
+			rtn = 1;
+			break;
+			}
+		else if(status != Z_OK && status != Z_BUF_ERROR) {
+			if(status == Z_MEM_ERROR) {
+				pInf->errNum = ENOMEM;
+				goto Fail;
+				}
+			goto Corrupt;
+			}
+		} while(pStrm->avail_out > 0);
+
+	pInf->blockLen[idx] = FIFileBufSize - pStrm->avail_out;
+	return rtn;
+Corrupt:
+	pInf->errNum = -1;
+Fail:
+	pInf->blockLen[idx] = 0;
+	return -1;
+	}
+
+// Decompress input file in a separate thread (producer), filling empty blocks as they are released by f_zread() (consumer)
+// until end of file, an error, or shutdown.
+static void *f_inflate(void *arg) {
+	Inflater *pInf = (Inflater *) arg;
+	int rtn;
+
+	(void) pthread_mutex_lock(&pInf->mutex);
+	for(;;) {
+		// Wait for an empty block.
+		while(pInf->freeCt == 0 && !pInf->stop)
+			(void) pthread_cond_wait(&pInf->cond, &pInf->mutex);
+		if(pInf->stop)
+			break;
+		--pInf->freeCt;
+		(void) pthread_mutex_unlock(&pInf->mutex);
+
+		// Fill it and pass it to consumer.
+		rtn = f_zblock(pInf, pInf->fillIdx);
+		(void) pthread_mutex_lock(&pInf->mutex);
+		if(pInf->blockLen[pInf->fillIdx] > 0) {
+			pInf->fillIdx = (pInf->fillIdx + 1) % FIZBlocks;
+			++pInf->readyCt;
+			}
+		else
+			++pInf->freeCt;
+		if(rtn != 0)
+			pInf->done = true;
+		(void) pthread_cond_signal(&pInf->cond);
+		if(pInf->done)
+			break;
+		}
+	(void) pthread_mutex_unlock(&pInf->mutex);
+	return NULL;
+	}
+
+// Begin decompressing (just opened) gzip input file.  Decompression is done in a separate thread if possible.  Return status.
+static int f_zstart(void) {
+	Inflater *pInf;
+
+	if((pInf = (Inflater *) malloc(sizeof(Inflater))) == NULL)
+		return rsset(Panic, 0, text94, "f_zstart");
+			// "%s(): Out of memory!"
+	pInf->strm.zalloc = Z_NULL;
+	pInf->strm.zfree = Z_NULL;
+	pInf->strm.opaque = Z_NULL;
+	pInf->strm.next_in = Z_NULL;
+	pInf->strm.avail_in = 0;
+	if(inflateInit2(&pInf->strm, 15 + 16) != Z_OK) {
+		free((void *) pInf);
+		return rsset(Panic, 0, text94, "f_zstart");
+		}
+	pInf->fileHandle = fileInfo.fileHandle;
+	pInf->freeCt = FIZBlocks;
+	pInf->readyCt = pInf->fillIdx = pInf->readIdx = 0;
+	pInf->held = pInf->done = pInf->stop = false;
+	pInf->errNum = 0;
+	pInf->memberCt = 0;
+	pInf->threaded = pthread_mutex_init(&pInf->mutex, NULL) == 0 && pthread_cond_init(&pInf->cond, NULL) == 0 &&
+	 pthread_create(&pInf->thread, NULL, f_inflate, (void *) pInf) == 0;
+	fileInfo.pInflater = pInf;
+
+	return sess.rtn.status;
+	}
+
+// Stop decompressing input file and release decompression state.  Must be called before the file is closed.
+static void f_zstop(void) {
+	Inflater *pInf = fileInfo.pInflater;
+
+	if(pInf->threaded) {
+		(void) pthread_mutex_lock(&pInf->mutex);
+		pInf->stop = true;
+		(void) pthread_cond_signal(&pInf->cond);
+		(void) pthread_mutex_unlock(&pInf->mutex);
+		(void) pthread_join(pInf->thread, NULL);
+		(void) pthread_cond_destroy(&pInf->cond);
+		(void) pthread_mutex_destroy(&pInf->mutex);
+		}
+	(void) inflateEnd(&pInf->strm);
+	free((void *) pInf);
+	fileInfo.pInflater = NULL;
+	}
+
+// Get next block of decompressed input, releasing the previous one, and store pointer to it in *pBuf.  Return number of bytes
+// in block, zero if end of file reached, or -1 if error (with exception set).
+static int f_zread(char **pBuf) {
+	Inflater *pInf = fileInfo.pInflater;
+	int n = 0;
+
+	if(pInf->threaded) {
+		(void) pthread_mutex_lock(&pInf->mutex);
+
+		// Release block returned by previous call, if any.
+		if(pInf->held) {
+			pInf->held = false;
+			pInf->readIdx = (pInf->readIdx + 1) % FIZBlocks;
+			++pInf->freeCt;
+			(void) pthread_cond_signal(&pInf->cond);
+			}
+
+		// Wait for next block.
+		while(pInf->readyCt == 0 && !pInf->done)
+			(void) pthread_cond_wait(&pInf->cond, &pInf->mutex);
+		if(pInf->readyCt > 0) {
+			--pInf->readyCt;
+			pInf->held = true;
+			n = pInf->blockLen[pInf->readIdx];
+			}
+		(void) pthread_mutex_unlock(&pInf->mutex);
+		}
+	else if(!pInf->done) {
+
+		// No producer thread: decompress next block here.
+		if(f_zblock(pInf, 0) != 0)
+			pInf->done = true;
+		n = pInf->blockLen[0];
+		}
+
+	if(n > 0)
+		*pBuf = pInf->blocks[pInf->readIdx];
+	else if(pInf->errNum != 0) {
+		(void) rsset(Failure, RSHigh, text141, pInf->errNum == -1 ? text512 : strerror(pInf->errNum), fileInfo.filename);
+				// "I/O Error: %s, file \"%s\"", "corrupt compressed data"
+		n = -1;
+		}
+	return n;
+	}
+
+// Free input line buffer and release input file mapping or decompression state, if any.
 static void f_free(void) {
 
 	if(fileInfo.lineBuf != NULL) {
 		free((void *) fileInfo.lineBuf);
 		fileInfo.lineBuf = NULL;
 		}
+	if(fileInfo.mapBase != NULL) {
+		(void) sigaction(SIGBUS, &oldBusAction, NULL);
+		(void) munmap((void *) fileInfo.mapBase, fileInfo.mapSize);
+		fileInfo.mapBase = NULL;
+		fileInfo.mapSize = 0;
+		}
+	if(fileInfo.pInflater != NULL)
+		f_zstop();
 	}
 
 // Initialize FileInfo object for input.  Return status.
@@ -261,12 +537,85 @@ int inpInit(int fileHandle) {
 	else if((fileInfo.realInpDelim2 = (short) fileInfo.userInpDelim.u.delim[1]) == 0)
 		fileInfo.realInpDelim2 = -1;
 	fileInfo.ioBufEnd = fileInfo.ioBufCur = fileInfo.dataBuf;
+	fileInfo.inpOffset = 0;
 
 	return sess.rtn.status;
 	}
 
+// SIGBUS handler, installed while an input file is mapped.  If the fault is in the mapping (because the file was truncated
+// while being read; for example, by log rotation), replace the rest of the mapping with zero-filled pages so that the scan can
+// continue, and set mapFault so that the read is failed by f_mapCheck().  Otherwise, restore the previous action so that the
+// fault is handled as usual when the faulting instruction is retried.  Note that mmap() is not on the POSIX list of
+// async-signal-safe functions, but it is a plain system call that takes no locks in user space, and the fault is synchronous
+// (raised by a load from the mapping, not by an interrupted library call).  Recovering with siglongjmp() instead is not an
+// option because the fault may occur in any of the f_parload() loader threads, which cannot jump to a context saved by the
+// main thread.
+static void f_mapFault(int sig, siginfo_t *pInfo, void *context) {
+	char *addr = (char *) pInfo->si_addr;
+
+	if(fileInfo.mapBase != NULL && addr >= fileInfo.mapBase && addr < fileInfo.mapBase + fileInfo.mapSize) {
+		char *page = fileInfo.mapBase + (addr - fileInfo.mapBase) / fileInfo.mapPageSize * fileInfo.mapPageSize;
+
+		if(mmap((void *) page, fileInfo.mapBase + fileInfo.mapSize - page, PROT_READ,
+		 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+			mapFault = 1;
+			return;
+			}
+		}
+	(void) sigaction(SIGBUS, &oldBusAction, NULL);
+	}
+
+// Check if mapped input file was truncated while being read.  If so, set an error and return true, otherwise false.
+static bool f_mapCheck(void) {
+
+	if(mapFault) {
+		(void) rsset(Failure, RSHigh, text141, text502, fileInfo.filename);
+			// "I/O Error: %s, file \"%s\"", "file was truncated or replaced"
+		return true;
+		}
+	return false;
+	}
+
+// Map the (just opened) input file into memory if it is a non-empty regular file and make the mapping the I/O buffer, so that
+// the entire file is scanned in place by f_getline() with no read() calls and no copying into dataBuf.  Pages are brought in by
+// the kernel on demand with aggressive read-ahead and may be dropped behind the scan.  (The lines themselves are still copied
+// into the buffer's line storage.)  A SIGBUS handler is installed while the file is mapped in case the file is truncated
+// during the read.  If the file cannot be mapped, leave FileInfo object as is so that the file is read via the I/O buffer.
+static void f_map(void) {
+	struct stat s;
+	struct sigaction action;
+	void *map;
+
+	if(fstat(fileInfo.fileHandle, &s) != 0 || !S_ISREG(s.st_mode) || s.st_size == 0 ||
+	 (uintmax_t) s.st_size > SIZE_MAX)
+		return;
+	fileInfo.mapPageSize = (size_t) sysconf(_SC_PAGESIZE);
+	action.sa_sigaction = f_mapFault;
+	action.sa_flags = SA_SIGINFO;
+	sigemptyset(&action.sa_mask);
+	if(sigaction(SIGBUS, &action, &oldBusAction) != 0)
+		return;
+	if((map = mmap(NULL, (size_t) s.st_size, PROT_READ, MAP_PRIVATE, fileInfo.fileHandle, 0)) == MAP_FAILED) {
+		(void) sigaction(SIGBUS, &oldBusAction, NULL);
+		return;
+		}
+#ifdef MADV_SEQUENTIAL
+	(void) madvise(map, (size_t) s.st_size, MADV_SEQUENTIAL);
+#endif
+	mapFault = 0;
+	fileInfo.ioBufEnd = (fileInfo.ioBufCur = fileInfo.mapBase = (char *) map) + (fileInfo.mapSize = (size_t) s.st_size);
+	fileInfo.inpOffset = s.st_size;
+	}
+
+// Return true if given (just opened) input file begins with the gzip magic number, otherwise false.
+static bool f_gzip(int fileHandle) {
+	uchar magic[2];
+
+	return pread(fileHandle, (void *) magic, 2, 0) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+	}
+
 // Open a file for reading.  If filename is NULL, use standard input (via file descriptor saved in fileInfo.stdInpFileHandle).
-// Return status.
+// A gzip-compressed file is decompressed transparently; any other regular file is mapped into memory.  Return status.
 static int f_ropen(const char *filename, bool required) {
 	int fileHandle;
 
@@ -276,7 +625,13 @@ static int f_ropen(const char *filename, bool required) {
 		return (required || errno != ENOENT) ? rsset(Failure, RSHigh, text141, strerror(errno), filename) : IONSF;
 							// "I/O Error: %s, file \"%s\""
 	saveFilename(filename);
-	return inpInit(fileHandle);
+	if(inpInit(fileHandle) == Success && filename != NULL) {
+		if(f_gzip(fileHandle))
+			(void) f_zstart();
+		else
+			f_map();
+		}
+	return sess.rtn.status;
 	}
 
 // Initialize FileInfo object for output.
@@ -285,7 +640,7 @@ void otpInit(Buffer *pBuf, int fileHandle) {
 	fileInfo.fileHandle = fileHandle;
 	fileInfo.flags = 0;
 
-	// Initialize buffer pointers and record delimiter.
+	// Initialize buffer pointers, output vector, and record delimiter.
 	fileInfo.ioBufEnd = (fileInfo.ioBufCur = fileInfo.dataBuf) + sizeof(fileInfo.dataBuf);
 	if(*fileInfo.userOtpDelim.u.delim != '\0') {		// Use user-assigned output delimiter if specified.
 		fileInfo.realOtpDelim.u.pDelim = fileInfo.userOtpDelim.u.delim;
@@ -338,26 +693,153 @@ static int f_io(bool doRead, char *buf, size_t size) {
 	return n;
 	}
 
-// Flush I/O buffer to output file.  Return status.
-static int f_flush(void) {
+// Initialize given output stream for writing to given file descriptor.
+static void f_sopen(OtpStream *pStream, int fileHandle, bool retry) {
 
-	if(f_io(false, fileInfo.dataBuf, fileInfo.ioBufCur - fileInfo.dataBuf) >= 0)
-		fileInfo.ioBufCur = fileInfo.dataBuf;
-	return sess.rtn.status;
+	pStream->fileHandle = fileHandle;
+	pStream->retry = retry;
+	pStream->bufEnd = (pStream->bufCur = pStream->buf) + sizeof(pStream->buf);
+	pStream->vecCt = 0;
+	pStream->count = 0;
+	pStream->errNum = 0;
+	pStream->pDeflater = NULL;
+	}
+
+// Begin compressing output of given (just opened) stream in gzip format.  Return zero if successful, otherwise -1 with error
+// number saved in stream.
+static int f_zopen(OtpStream *pStream) {
+	Deflater *pDeflater;
+
+	if((pDeflater = (Deflater *) malloc(sizeof(Deflater))) == NULL)
+		goto Fail;
+	pDeflater->strm.zalloc = Z_NULL;
+	pDeflater->strm.zfree = Z_NULL;
+	pDeflater->strm.opaque = Z_NULL;
+	if(deflateInit2(&pDeflater->strm, FIZLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		free((void *) pDeflater);
+Fail:
+		pStream->errNum = ENOMEM;
+		return -1;
+		}
+	pStream->pDeflater = pDeflater;
+	return 0;
+	}
+
+// Compress pending input of given stream's Deflater object, writing compressed output as the output buffer fills.  If flush is
+// Z_FINISH, complete the gzip member.  Return zero if successful, otherwise -1 with error number saved in stream.
+static int f_deflate(OtpStream *pStream, int flush) {
+	ssize_t n;
+	const Bytef *buf;
+	size_t len;
+	int status;
+	z_stream *pStrm = &pStream->pDeflater->strm;
+
+	do {
+		pStrm->next_out = pStream->pDeflater->buf;
+		pStrm->avail_out = FIFileBufSize;
+		if((status = deflate(pStrm, flush)) == Z_STREAM_ERROR) {
+			pStream->errNum = EIO;
+			return -1;
+			}
+
+		// Write compressed output, resuming after partial writes.
+		buf = pStream->pDeflater->buf;
+		len = FIFileBufSize - pStrm->avail_out;
+		while(len > 0) {
+			if((n = write(pStream->fileHandle, (const void *) buf, len)) == -1) {
+				if(errno == EINTR)
+					continue;
+				pStream->errNum = errno;
+				return -1;
+				}
+			pStream->count += n;
+			buf += n;
+			len -= n;
+			}
+		} while(flush == Z_FINISH ? status != Z_STREAM_END : pStrm->avail_out == 0);
+
+	return 0;
+	}
+
+// End compression of given stream, completing the gzip member first if "finish" is true, and release compression state.
+// Return zero if successful, otherwise -1 with error number saved in stream.
+static int f_zclose(OtpStream *pStream, bool finish) {
+	int rtn = 0;
+
+	pStream->pDeflater->strm.avail_in = 0;
+	if(finish)
+		rtn = f_deflate(pStream, Z_FINISH);
+	(void) deflateEnd(&pStream->pDeflater->strm);
+	free((void *) pStream->pDeflater);
+	pStream->pDeflater = NULL;
+	return rtn;
+	}
+
+// Write pending output vector of given stream with writev(), resuming after partial writes and retrying if applicable (as in
+// f_io()), then reset vector and staging buffer.  If stream is compressed, pass the vector entries through the compressor
+// instead.  Return zero if successful, otherwise -1 with error number saved in stream.
+static int f_flush(OtpStream *pStream) {
+	ssize_t n;
+	struct iovec *pVec = pStream->vec;
+	struct iovec *pVecEnd = pVec + pStream->vecCt;
+	int pipeDelay = FIPipeDelay;
+	int loopCount = pStream->retry ? FIPipeAttempts : 1;
+
+	// Compress vector entries if applicable (leaving none to write below).
+	if(pStream->pDeflater != NULL) {
+		for(; pVec < pVecEnd; ++pVec) {
+			pStream->pDeflater->strm.next_in = (Bytef *) pVec->iov_base;
+			pStream->pDeflater->strm.avail_in = pVec->iov_len;
+			if(f_deflate(pStream, Z_NO_FLUSH) != 0)
+				return -1;
+			}
+		}
+	while(pVec < pVecEnd) {
+		if((n = writev(pStream->fileHandle, pVec, pVecEnd - pVec)) == -1) {
+
+			// Write failed.  Return error if unexpected or maximum retries reached.
+			if(errno != EAGAIN || --loopCount == 0) {
+				pStream->errNum = errno;
+				return -1;
+				}
+
+			// Pause and try again.
+			centiPause(pipeDelay++);
+			continue;
+			}
+
+		// Skip entries that were written completely and adjust partially-written one, if any.
+		pStream->count += n;
+		while(pVec < pVecEnd && (size_t) n >= pVec->iov_len)
+			n -= pVec++->iov_len;
+		if(n > 0) {
+			pVec->iov_base = (char *) pVec->iov_base + n;
+			pVec->iov_len -= n;
+			}
+		}
+
+	pStream->vecCt = 0;
+	pStream->bufCur = pStream->buf;
+	return 0;
 	}
 
-// Close current file, reset file information, and note buffer delimiters.
+// Close current file, reset file information, and note buffer delimiters.  Output must have been flushed.
 static int f_close(bool otpFile) {
 
-	// Flush output if needed and close file.
-	if(otpFile && fileInfo.ioBufCur > fileInfo.dataBuf && f_flush() != Success)
-		(void) close(fileInfo.fileHandle);
-	else if(fileInfo.fileHandle >= 0 && close(fileInfo.fileHandle) == -1)
+	// Free line buffer and input state (stopping any decompression thread before its file is closed).
+	f_free();
+
+	// Close file.
+#ifdef SYNC_FILE_RANGE_WRITE
+	// Start writeback of file being saved durably, so that it proceeds while other files are written.
+	if(otpFile && (fileInfo.flags & FIDurable))
+		(void) sync_file_range(fileInfo.fileHandle, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+	if(fileInfo.fileHandle >= 0 && close(fileInfo.fileHandle) == -1)
 		(void) rsset(Failure, RSHigh, text141, strerror(errno), fileInfo.filename);
 				// "I/O Error: %s, file \"%s\""
 
-	// Free line buffer and reset controls.
-	f_free();
+	// Reset controls.
 	fileInfo.fileHandle = -1;
 	fileInfo.filename = NULL;
 
@@ -380,193 +862,269 @@ static int f_close(bool otpFile) {
 	return sess.rtn.status;
 	}
 
-// Write bytes to the current (already opened) file with buffering.  Return status.
-static int f_write(const char *buf, int bufLen) {
+// Add bytes to output vector of given stream, flushing the vector when full.  Short strings are copied into the staging
+// buffer, where consecutive ones are coalesced into a single vector entry; longer ones are referenced in place and thus not
+// copied at all (they must remain valid until the next flush).  Return zero if successful, otherwise -1.
+static int f_write(OtpStream *pStream, const char *buf, int bufLen) {
+	struct iovec *pVec;
 
-	// Time for buffer flush?
-	if(fileInfo.ioBufCur > fileInfo.dataBuf && fileInfo.ioBufCur + bufLen > fileInfo.ioBufEnd) {
+	if(bufLen == 0)
+		return 0;
 
-		// Yes, flush it.
-		if(f_flush() != Success)
-			return sess.rtn.status;
+	// Time for flush?
+	if(pStream->vecCt == FIOtpVecMax || (bufLen < FIOtpCopyMax && pStream->bufCur + bufLen > pStream->bufEnd)) {
+		if(f_flush(pStream) != 0)
+			return -1;
 		}
 
-	// Will string fit in buffer?
-	if(fileInfo.ioBufCur + bufLen <= fileInfo.ioBufEnd) {
+	if(bufLen >= FIOtpCopyMax) {
 
-		// Yes, store it.
-		memcpy(fileInfo.ioBufCur, buf, bufLen);
-		fileInfo.ioBufCur += bufLen;
+		// Long string: add vector entry for it.
+		pVec = pStream->vec + pStream->vecCt++;
+		pVec->iov_base = (void *) buf;
+		pVec->iov_len = bufLen;
+		}
+	else {
+		// Short string: copy it into staging buffer, extending last vector entry if it ends there.
+		pVec = pStream->vec + pStream->vecCt;
+		if(pStream->vecCt == 0 || (char *) pVec[-1].iov_base + pVec[-1].iov_len != pStream->bufCur) {
+			++pStream->vecCt;
+			pVec->iov_base = (void *) pStream->bufCur;
+			pVec->iov_len = 0;
+			}
+		else
+			--pVec;
+		memcpy(pStream->bufCur, buf, bufLen);
+		pStream->bufCur += bufLen;
+		pVec->iov_len += bufLen;
 		}
-	else
-		// Won't fit.  Write it directly.
-		(void) f_io(false, (char *) buf, bufLen);
 
-	return sess.rtn.status;
+	return 0;
 	}
 
-// Write given line to the current (already opened) file.  Return status.
-static int f_putline(Line *pLine, bool writeDelim) {
-
-	// Write the line and appropriate line delimiter(s), and check for errors.
-	if(f_write(pLine->text, pLine->used) == Success && writeDelim)
-		(void) f_write(fileInfo.realOtpDelim.u.pDelim, fileInfo.realOtpDelim.len);
+// Write lines of given buffer to given output stream, each followed by given line delimiter except the last, unless addNL is
+// true.  Set *pLineCt to number of lines written and flush the stream, completing and releasing its compressor, if any.  This
+// routine does not access any global state, so it may be run in a worker thread.  Return zero if successful, otherwise -1.
+static int f_writeLines(OtpStream *pStream, Buffer *pBuf, const char *delim, ushort delimLen, bool addNL, uint *pLineCt) {
+	Line *pLine, *pLineEnd;
+	uint lineCt = 0;
 
-	return sess.rtn.status;
+	pLineEnd = (pLine = pBuf->pFirstLine)->prev;
+	while(pLine != pLineEnd || addNL || pLine->used > 0) {
+		if(f_write(pStream, pLine->text, pLine->used) != 0 ||
+		 ((pLine != pLineEnd || addNL) && f_write(pStream, delim, delimLen) != 0))
+			goto Fail;
+		++lineCt;
+		if((pLine = pLine->next) == NULL)
+			break;
+		}
+	*pLineCt = lineCt;
+	if(f_flush(pStream) == 0 && (pStream->pDeflater == NULL || f_zclose(pStream, true) == 0))
+		return 0;
+Fail:
+	if(pStream->pDeflater != NULL)
+		(void) f_zclose(pStream, false);
+	return -1;
 	}
 
-// Add a character to fileInfo.lineBuf, expanding it as needed.  Return status.
-static int f_putc(short c) {
+// Append bytes to fileInfo.lineBuf, expanding it as needed.  Return status.
+static int f_putstr(const char *str, uint len) {
 	uint n1, n2;
 
-	// Line buffer full?
-	if(fileInfo.lineBufCur == fileInfo.lineBufEnd) {
+	// Line buffer too small?
+	if(fileInfo.lineBufCur + len > fileInfo.lineBufEnd) {
 
 		// Yes, get more space.
-		n1 = n2 = fileInfo.lineBufCur - fileInfo.lineBuf;
-		if((fileInfo.lineBuf = (char *) realloc((void *) fileInfo.lineBuf, n2 *= 2)) == NULL)
-			return rsset(Panic, 0, text156, "f_putc", n2, fileInfo.filename);
+		n1 = fileInfo.lineBufCur - fileInfo.lineBuf;
+		n2 = fileInfo.lineBufEnd - fileInfo.lineBuf;
+		do {
+			n2 *= 2;
+			} while(n1 + len > n2);
+		if((fileInfo.lineBuf = (char *) realloc((void *) fileInfo.lineBuf, n2)) == NULL)
+			return rsset(Panic, 0, text156, "f_putstr", n2, fileInfo.filename);
 				// "%s(): Out of memory allocating %u-byte line buffer for file \"%s\"!"
-		fileInfo.lineBufEnd = (fileInfo.lineBufCur = fileInfo.lineBuf + n1) + n1;
+		fileInfo.lineBufCur = fileInfo.lineBuf + n1;
+		fileInfo.lineBufEnd = fileInfo.lineBuf + n2;
 		}
 
-	// Append character and return sess.rtn.status;
-	*fileInfo.lineBufCur++ = c;
+	// Append bytes and return status.
+	memcpy(fileInfo.lineBufCur, str, len);
+	fileInfo.lineBufCur += len;
 	return sess.rtn.status;
 	}
 
-// Get next character from (opened) input file and store in *pChar.  Return status, including IOEOF if end of file reached.
-static int f_getc(short *pChar) {
+// Refill I/O buffer from (opened) input file.  Return status, including IOEOF if end of file reached.
+static int f_fill(void) {
 	int n;
+	char *buf = fileInfo.dataBuf;
 
 	// At EOF?
 	if(fileInfo.flags & FIEOF)
-		goto EOFRetn;
-
-	// Buffer empty?
-	if(fileInfo.ioBufCur == fileInfo.ioBufEnd) {
+		return IOEOF;
 
-		// Yep, refill it.
-		if((n = f_io(true, fileInfo.dataBuf, FIFileBufSize)) == -1)
+	// Read next block (unless input file is mapped, in which case the whole file has been consumed).  If input file is
+	// compressed, get next decompressed block instead, which is scanned in place.
+	if(fileInfo.mapBase != NULL)
+		n = 0;
+	else if(fileInfo.pInflater != NULL) {
+		if((n = f_zread(&buf)) == -1)
 			return sess.rtn.status;
+		}
+	else if((n = f_io(true, fileInfo.dataBuf, FIFileBufSize)) == -1)
+		return sess.rtn.status;
 
-		// Hit EOF?
-		if(n == 0) {
-
-			// Yep, note it...
-			fileInfo.flags |= FIEOF;
-EOFRetn:
-			// and return it.
-			*pChar = -1;
-			return IOEOF;
-			}
+	// Hit EOF?
+	if(n == 0) {
 
-		// No, update buffer pointers.
-		fileInfo.ioBufEnd = (fileInfo.ioBufCur = fileInfo.dataBuf) + n;
+		// Yep, note it and return it.
+		fileInfo.flags |= FIEOF;
+		return IOEOF;
 		}
 
-	*pChar = (short) *fileInfo.ioBufCur++;
+	// No, update buffer pointers.
+	fileInfo.ioBufEnd = (fileInfo.ioBufCur = buf) + n;
+	fileInfo.inpOffset += n;
 	return sess.rtn.status;
 	}
 
-// Read a line from a file into fileInfo.lineBuf and store the byte count and delimiter status in the supplied pointers.  Check
-// for I/O errors and return status.  *hasDelimp is not set unless at least one byte was read (so the returned value from a
-// previous call will remain valid).
-static int f_getline(uint *len, bool *hasDelimp) {
+// Read a line from a file and store a pointer to its text, the byte count, and delimiter status in the supplied pointers.
+// Check for I/O errors and return status.  *hasDelimp is not set unless at least one byte was read (so the returned value from
+// a previous call will remain valid).
+//
+// The I/O buffer is scanned for the delimiter with memchr().  If the line lies entirely within the buffer (which is always the
+// case if the input file is mapped), *pText points into the buffer and the text is not copied; otherwise, the line spans one
+// or more buffer refills and its pieces are accumulated in fileInfo.lineBuf.  Either way, the text is valid until the next
+// call.
+static int f_getline(const char **pText, uint *len, bool *hasDelimp) {
 	int status;
+	const char *seg, *lineEnd;
+	char *str, *str1;
+	size_t n;
 	short c;
-	uint lineLen;
+	bool refilled;
 	bool hasDelim = false;
 
 	// If we are at EOF, bail out.
 	if(fileInfo.flags & FIEOF)
 		return IOEOF;
 
-	// Initialize.
-	fileInfo.lineBufCur = fileInfo.lineBuf;		// Current line buffer pointer.
-
-	// Input line delimiters undefined?
-	if(fileInfo.realInpDelim1 == -1) {
+	// Initialize.  Text of current line not yet saved in the line buffer is from seg to lineEnd in the I/O buffer.
+	fileInfo.lineBufCur = fileInfo.lineBuf;
+	seg = lineEnd = fileInfo.ioBufCur;
 
-		// Yes.  Read bytes until a NL or CR found, or EOF reached.
-		for(;;) {
-			if((status = f_getc(&c)) == IOEOF)
+	for(;;) {
+		// I/O buffer exhausted?  If so, save partial line and refill it.
+		if(fileInfo.ioBufCur == fileInfo.ioBufEnd) {
+			if(fileInfo.ioBufCur > seg && f_putstr(seg, fileInfo.ioBufCur - seg) != Success)
+				return sess.rtn.status;
+			status = f_fill();
+			seg = lineEnd = fileInfo.ioBufCur;
+			if(status == IOEOF)
 				goto EOLn;
 			if(status != Success)
 				return sess.rtn.status;
-			if(c == '\n') {
-				fileInfo.realInpDelim1 = '\n';
-				fileInfo.realInpDelim2 = -1;
-				goto DelimFound;
-				}
-			if(c == '\r') {
-				fileInfo.realInpDelim1 = '\r';
-				if((status = f_getc(&c)) == IOEOF)
-					goto CR;
-				if(status != Success)
-					return sess.rtn.status;
-				if(c == '\n') {
-					fileInfo.realInpDelim2 = '\n';
-					goto DelimFound;
-					}
+			}
+
+		// Scan for first delimiter.  If delimiters are undefined, look for a NL or CR, whichever comes first.
+		n = fileInfo.ioBufEnd - fileInfo.ioBufCur;
+		if(fileInfo.realInpDelim1 == -1) {
+			if((str = memchr(fileInfo.ioBufCur, '\n', n)) != NULL)
+				n = str - fileInfo.ioBufCur;
+			if((str1 = memchr(fileInfo.ioBufCur, '\r', n)) != NULL)
+				str = str1;
+			}
+		else
+			str = memchr(fileInfo.ioBufCur, fileInfo.realInpDelim1, n);
+		if(str == NULL) {
+
+			// Not found... onward.
+			fileInfo.ioBufCur = fileInfo.ioBufEnd;
+			continue;
+			}
+		lineEnd = str;
+		fileInfo.ioBufCur = str + 1;
 
-				// Not a CR-LF sequence; "unget" the last character.
-				--fileInfo.ioBufCur;
-CR:
+		// Found NL (delimiters undefined) or single delimiter?
+		if(fileInfo.realInpDelim1 == -1) {
+			if(*str == '\n') {
+				fileInfo.realInpDelim1 = '\n';
 				fileInfo.realInpDelim2 = -1;
 				goto DelimFound;
 				}
+			}
+		else if(fileInfo.realInpDelim2 == -1)
+			goto DelimFound;
 
-			// No NL or CR found yet... onward.
-			if(f_putc(c) != Success)
+		// Found CR or first of two delimiters.  Get next character, refilling the I/O buffer if needed.
+		refilled = false;
+		if(fileInfo.ioBufCur == fileInfo.ioBufEnd) {
+			if(lineEnd > seg && f_putstr(seg, lineEnd - seg) != Success)
+				return sess.rtn.status;
+			if((status = f_fill()) != Success && status != IOEOF)
 				return sess.rtn.status;
+			seg = lineEnd = fileInfo.ioBufCur;
+			refilled = true;
+			c = (status == IOEOF) ? -1 : (short) *fileInfo.ioBufCur;
 			}
-		}
-
-	// We have line delimiter(s)... read next line.
-	for(;;) {
-		if((status = f_getc(&c)) == IOEOF)
-			goto EOLn;
-		if(status != Success)
-			return sess.rtn.status;
-		if(c == fileInfo.realInpDelim1) {
+		else
+			c = (short) *fileInfo.ioBufCur;
 
-			// Got match on first delimiter.  Need two?
-			if(fileInfo.realInpDelim2 == -1)
+		// Delimiters undefined?
+		if(fileInfo.realInpDelim1 == -1) {
 
-				// Nope, we're done.
-				goto DelimFound;
+			// Yes, CR found.  Check for CR-LF sequence.
+			fileInfo.realInpDelim1 = '\r';
+			if(c == '\n') {
+				fileInfo.realInpDelim2 = '\n';
+				++fileInfo.ioBufCur;
+				}
+			else
+				fileInfo.realInpDelim2 = -1;
+			goto DelimFound;
+			}
+		if(c == fileInfo.realInpDelim2) {
 
-			// Yes, check next character.
-			if((status = f_getc(&c)) != IOEOF) {
-				if(status != Success)
-					return sess.rtn.status;
-				if(c == fileInfo.realInpDelim2)
+			// Second delimiter matches also, we're done.
+			++fileInfo.ioBufCur;
+			goto DelimFound;
+			}
 
-					// Second delimiter matches also, we're done.
-					goto DelimFound;
+		// Two delimiters needed, but only one found.  It is part of the line, so save it if it is no longer in the I/O
+		// buffer and move onward.
+		if(refilled) {
+			char delim = fileInfo.realInpDelim1;
 
-				// Not a match; "unget" the last character.
-				--fileInfo.ioBufCur;
-				c = fileInfo.realInpDelim1;
-				}
+			if(f_putstr(&delim, 1) != Success)
+				return sess.rtn.status;
 			}
-
-		// Delimiter not found, or two delimiters needed, but only one found.  Save the character and move onward.
-		if(f_putc(c) != Success)
-			return sess.rtn.status;
 		}
 DelimFound:
 	hasDelim = true;
 EOLn:
+	// Get line text and length.
+	if(fileInfo.lineBufCur > fileInfo.lineBuf) {
+		if(lineEnd > seg && f_putstr(seg, lineEnd - seg) != Success)
+			return sess.rtn.status;
+		*pText = fileInfo.lineBuf;
+		n = fileInfo.lineBufCur - fileInfo.lineBuf;
+		}
+	else {
+		*pText = seg;
+		n = lineEnd - seg;
+		}
+
+	// Mapped file truncated?
+	if(fileInfo.mapBase != NULL && f_mapCheck())
+		return sess.rtn.status;
+
 	// Hit EOF and nothing read?
-	if((lineLen = fileInfo.lineBufCur - fileInfo.lineBuf) == 0 && (fileInfo.flags & FIEOF))
+	if(n == 0 && (fileInfo.flags & FIEOF))
 
 		// Yes.
 		return IOEOF;
 
 	// Got a (possibly zero-length) line.  Save the length for the caller and return delimiter status if non-zero.
-	if((*len = lineLen) > 0)
+	if((*len = n) > 0)
 		*hasDelimp = hasDelim;
 
 	return sess.rtn.status;
@@ -579,7 +1137,7 @@ int insertLine(const char *src, int len, bool hasDelim, Buffer *pBuf, Point *pPo
 
 	// Allocate new buffer line for text to be inserted plus a portion of the point line, depending on point's position.
 	size = len + (hasDelim ? pPoint->offset : pPoint->pLine->used);
-	if(lalloc(size, &pLine) != Success)
+	if(lpalloc(size, pBuf, &pLine) != Success)
 		return sess.rtn.status;						// Fatal error.
 	if(hasDelim && pPoint->offset == 0)
 		memcpy(pLine->text, src, len);					// Copy line.
@@ -596,6 +1154,7 @@ int insertLine(const char *src, int len, bool hasDelim, Buffer *pBuf, Point *pPo
 		while(src < strEnd)
 			*dest++ = *src++;
 		if(hasDelim) {
+			pBuf->byteTotal -= pPoint->offset;			// Text before point moves to new line.
 			if(pPoint->offset == pPoint->pLine->used)		// Shift any remaining text to BOL.
 				pPoint->offset = pPoint->pLine->used = 0;	// Nothing left.
 			else {
@@ -626,6 +1185,172 @@ int insertLine(const char *src, int len, bool hasDelim, Buffer *pBuf, Point *pPo
 	return sess.rtn.status;
 	}
 
+// Find next line delimiter in mapped input at or after str and before end.  Delimiters must be known.  Return pointer to
+// delimiter and set *pNext to position following it, or return NULL if not found.
+static const char *f_finddelim(const char *str, const char *end, const char **pNext) {
+	const char *str1;
+
+	for(;;) {
+		if((str1 = memchr(str, fileInfo.realInpDelim1, end - str)) == NULL)
+			return NULL;
+		if(fileInfo.realInpDelim2 == -1) {
+			*pNext = str1 + 1;
+			return str1;
+			}
+		if(str1 + 1 < end && str1[1] == fileInfo.realInpDelim2) {
+			*pNext = str1 + 2;
+			return str1;
+			}
+		str = str1 + 1;
+		}
+	}
+
+// Build the lines in a LoadJob range (thread routine).  Only the shared, read-only fileInfo delimiters are referenced.
+static void *f_loadjob(void *arg) {
+	LoadJob *pJob = (LoadJob *) arg;
+	const char *str = pJob->start;
+	const char *delim, *next;
+	Line *pLine;
+
+	while((delim = f_finddelim(str, pJob->end, &next)) != NULL) {
+		if((pLine = lpnew(&pJob->linePool, str, delim - str)) == NULL) {
+			pJob->outOfMem = true;
+			break;
+			}
+		if((pLine->prev = pJob->pLastLine) == NULL)
+			pJob->pFirstLine = pLine;
+		else
+			pJob->pLastLine->next = pLine;
+		pJob->pLastLine = pLine;
+		++pJob->lineCt;
+		pJob->byteCt += pLine->used;
+		str = next;
+		}
+	if(pJob->pLastLine != NULL)
+		pJob->pLastLine->next = NULL;
+	pJob->stop = str;
+	return NULL;
+	}
+
+// Load up to FIParLoadRound bytes of delimited lines from a mapped input file in parallel and insert them before point line in
+// target buffer, which must be at beginning of line.  The mapped text is split into ranges at line boundaries, each range is
+// processed by f_loadjob() in its own thread, and the resulting line lists are spliced into the buffer in order.  If the end
+// of the file is reached, any trailing text without a delimiter is left in the I/O buffer for f_getline().  Return status.
+static int f_parload(DataInsert *pDataInsert, Point *pPoint) {
+	long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+	int jobCount, i;
+	size_t size;
+	const char *str, *end, *next;
+	bool outOfMem = false;
+
+	// Use serial path if only one CPU.
+	if(cpuCount < 2)
+		return sess.rtn.status;
+	jobCount = (cpuCount > FIParLoadMax) ? FIParLoadMax : cpuCount;
+
+	// Determine end of this round.
+	end = fileInfo.ioBufEnd;
+	if((size_t) (end - fileInfo.ioBufCur) > FIParLoadRound &&
+	 f_finddelim(fileInfo.ioBufCur + FIParLoadRound, end, &next) != NULL)
+		end = next;
+	size = end - fileInfo.ioBufCur;
+
+	LoadJob jobs[jobCount];
+	pthread_t threads[jobCount];
+	bool started[jobCount];
+
+	// Split input into ranges at line boundaries.
+	str = fileInfo.ioBufCur;
+	for(i = 0; i < jobCount; ++i) {
+		jobs[i].start = str;
+		if(i == jobCount - 1)
+			str = end;
+		else if(str < fileInfo.ioBufCur + size / jobCount * (i + 1) &&
+		 f_finddelim(fileInfo.ioBufCur + size / jobCount * (i + 1), end, &next) != NULL)
+			str = next;
+		jobs[i].end = str;
+		lpinit(&jobs[i].linePool);
+		jobs[i].pFirstLine = jobs[i].pLastLine = NULL;
+		jobs[i].lineCt = jobs[i].byteCt = 0;
+		jobs[i].outOfMem = false;
+		}
+
+	// Start a thread for each range but the first, process the first one in this thread, then wait for the others.  If a
+	// thread cannot be created, process its range here instead.
+	for(i = 1; i < jobCount; ++i)
+		if(!(started[i] = (pthread_create(threads + i, NULL, f_loadjob, (void *) (jobs + i)) == 0)))
+			(void) f_loadjob((void *) (jobs + i));
+	(void) f_loadjob((void *) jobs);
+	for(i = 1; i < jobCount; ++i)
+		if(started[i])
+			(void) pthread_join(threads[i], NULL);
+
+	// Splice line lists into buffer in order (or free them if any thread ran out of memory or the file was truncated).
+	for(i = 0; i < jobCount; ++i)
+		if(jobs[i].outOfMem)
+			outOfMem = true;
+	for(i = 0; i < jobCount; ++i) {
+		if(outOfMem || mapFault) {
+			Line *pLine, *pLine1;
+
+			for(pLine = jobs[i].pFirstLine; pLine != NULL; pLine = pLine1) {
+				pLine1 = (pLine == jobs[i].pLastLine) ? NULL : pLine->next;
+				if(pLine->size > LinePoolMax)
+					free((void *) pLine);
+				}
+			lpfree(&jobs[i].linePool);
+			}
+		else {
+			if(jobs[i].pFirstLine != NULL)
+				lsplice(jobs[i].pFirstLine, jobs[i].pLastLine, jobs[i].lineCt, jobs[i].byteCt,
+				 pDataInsert->pTargBuf, pPoint->pLine);
+			lpmerge(&pDataInsert->pTargBuf->linePool, &jobs[i].linePool);
+			pDataInsert->lineCt += jobs[i].lineCt;
+			}
+		}
+	if(f_mapCheck())
+		return sess.rtn.status;
+	if(outOfMem)
+		return rsset(Panic, 0, text94, "f_parload");
+			// "%s(): Out of memory!"
+
+	// Advance past lines loaded, leaving any trailing text for f_getline().
+	fileInfo.ioBufCur = (char *) jobs[jobCount - 1].stop;
+	return sess.rtn.status;
+	}
+
+// Report progress of a file read in interactive mode on the message line and check for the abort key.  Windows are not
+// updated because the target buffer is only partly built.  Return status, or UserAbort if user pressed the abort key.
+static int f_progress(DataInsert *pDataInsert) {
+	int keyCount;
+	ushort extKey;
+
+	if((sess.opFlags & (OpVTermOpen | OpScript | OpStartup)) != OpVTermOpen || curMacro.state == MacPlay)
+		return sess.rtn.status;
+
+	// Show progress.
+	if((fileInfo.mapBase != NULL ? mlprintf(MLHome | MLFlush, "%s %u%%", pDataInsert->msg,
+	 (uint) ((fileInfo.ioBufCur - fileInfo.mapBase) * 100 / fileInfo.mapSize)) :
+	 mlprintf(MLHome | MLFlush, "%s %u %ss", pDataInsert->msg, pDataInsert->lineCt, text205)) != Success)
+			// "line"
+		return sess.rtn.status;
+
+	// Check for abort key.  Put back any other key.
+	if(typahead(&keyCount) != Success)
+		return sess.rtn.status;
+	if(keyCount > 0 || keyEntry.isPending) {
+		if(getkey(false, &extKey, false) != Success)
+			return sess.rtn.status;
+		if(extKey == coreKeys[CK_Abort].extKey) {
+			tbeep();
+			return UserAbort;
+			}
+		ungetkey(extKey);
+		}
+
+	return sess.rtn.status;
+	}
+
 // Read data from a buffer or file, insert at point in target buffer, and return status.  DataInsert object contains additional
 // input and output parameters.  If pSrcBuf is not NULL, lines are "read" from that buffer; otherwise, they are read from
 // current (opened) input file, status parameter is set to result, and finalDelim parameter is set to true if last line read had
@@ -638,6 +1363,8 @@ int insertData(int n, Buffer *pSrcBuf, DataInsert *pDataInsert) {
 	Line *pLine0;
 	int windPos;
 	int len;
+	uint nextTick;
+	const char *text;
 	bool hasDelim = true;
 
 	// Point given?
@@ -672,10 +1399,27 @@ int insertData(int n, Buffer *pSrcBuf, DataInsert *pDataInsert) {
 		// assumed that the point line is last line of the buffer.
 		if(mlputs(MLHome | MLWrap | MLFlush, pDataInsert->msg) != Success)		// Let user know what's up...
 			return sess.rtn.status;
-		while((pDataInsert->status = f_getline(&len, &hasDelim)) == Success) {		// and read the file.
-			if(insertLine(fileInfo.lineBuf, len, hasDelim, pDataInsert->pTargBuf, pPoint) != Success)
+		nextTick = FIProgressLines;
+		while((pDataInsert->status = f_getline(&text, &len, &hasDelim)) == Success) {	// and read the file.
+			if(insertLine(text, len, hasDelim, pDataInsert->pTargBuf, pPoint) != Success)
 				return sess.rtn.status;
 			++pDataInsert->lineCt;
+
+			// Load the rest of a large mapped file in parallel once the line delimiters are known (unless they
+			// are identical, in which case line boundaries cannot be found from an arbitrary position).
+			if(fileInfo.mapBase != NULL && fileInfo.ioBufEnd - fileInfo.ioBufCur >= FIParLoadMin &&
+			 fileInfo.realInpDelim1 != fileInfo.realInpDelim2 &&
+			 f_parload(pDataInsert, pPoint) != Success)
+				return sess.rtn.status;
+
+			// Time for a progress update?  If so, stop reading if user cancelled.
+			if(pDataInsert->lineCt >= nextTick) {
+				if((pDataInsert->status = f_progress(pDataInsert)) == UserAbort)
+					break;
+				if(pDataInsert->status != Success)
+					return sess.rtn.status;
+				nextTick = pDataInsert->lineCt + FIProgressLines;
+				}
 			}
 
 		// Last read was unsuccessful, check for errors.
@@ -690,13 +1434,12 @@ int insertData(int n, Buffer *pSrcBuf, DataInsert *pDataInsert) {
 
 	// Update line pointers if last line inserted had no delimiter (causing point line to be reallocated by insertLine()).
 	if(!hasDelim) {
-		if(pDataInsert->pTargBuf->windCount > 0)
-			fixFace(point0.offset, len, pLine0, pPoint->pLine);
 		fixBufFace(pDataInsert->pTargBuf, point0.offset, len, pLine0, pPoint->pLine);
 		}
 
 	// All lines inserted.  Set mark RegionMark to first inserted line and restore original window framing, if applicable.
 	if(pDataInsert->pTargPoint == NULL) {
+		mregclear(pDataInsert->pTargBuf);
 		pDataInsert->pTargBuf->markHdr.point.pLine = (point0.pLine == NULL) ? pDataInsert->pTargBuf->pFirstLine :
 		 point0.pLine->next;
 		pDataInsert->pTargBuf->markHdr.point.offset = point0.offset;
@@ -742,12 +1485,26 @@ uint fileExists(const char *filename) {
 	return 0;
 	}
 
+// Format given number of bytes in binary-multiple units into given buffer and return it.
+static char *f_scaled(double n, char *buf) {
+	static const char *units[] = {"KB", "MB", "GB", "TB", NULL};
+	const char **pUnit = units;
+
+	n /= 1024.0;
+	while(n >= 1024.0 && pUnit[1] != NULL) {
+		n /= 1024.0;
+		++pUnit;
+		}
+	sprintf(buf, "%.1f %s", n, *pUnit);
+	return buf;
+	}
+
 // Report I/O results as a return message, given active fabrication object.  Return status.
 int ioStat(DFab *rtnMsg, ushort flags, Datum *pBakName, int status, const char *filename, const char *action, uint lineCt) {
 	char *str;
 
 	// Report any non-fatal read or close error.
-	if(!(flags & IOS_OtpFile) && status < Success) {
+	if(!(flags & IOS_OtpFile) && status < Success && status != UserAbort) {
 		if(dputf(rtnMsg, 0, text141, strerror(errno), filename == NULL ? stdinFilename : filename) != 0 ||
 				// "I/O Error: %s, file \"%s\""
 		 dputc(' ', rtnMsg, 0) != 0)
@@ -764,6 +1521,16 @@ int ioStat(DFab *rtnMsg, ushort flags, Datum *pBakName, int status, const char *
 				// "line"
 		goto LibFail;
 
+	// Report output size and throughput.
+	if(flags & IOS_Rate) {
+		char workBuf1[24], workBuf2[24];
+
+		if(dputf(rtnMsg, 0, text503, f_scaled((double) otpCount, workBuf1), otpTime) != 0 || (otpTime > 0.0 &&
+		 dputf(rtnMsg, 0, text504, f_scaled((double) otpCount / otpTime, workBuf2)) != 0))
+				// ", %s in %.3f sec", " (%s/sec)"
+			goto LibFail;
+		}
+
 	// Non-standard line delimiter(s)?
 	str = (flags & IOS_OtpFile) ? fileInfo.realOtpDelim.u.pDelim : sess.cur.pBuf->inpDelim.u.delim;
 	if(str[0] != '\0' && (str[0] != '\n' || str[1] != '\0')) {
@@ -772,8 +1539,13 @@ int ioStat(DFab *rtnMsg, ushort flags, Datum *pBakName, int status, const char *
 			goto LibFail;
 		}
 
-	// Missing line delimiter at EOF?
-	if((flags & IOS_NoDelim) && dputs(text291, rtnMsg, 0) != 0)
+	// Read cancelled by user or missing line delimiter at EOF?
+	if(status == UserAbort) {
+		if(dputs(text500, rtnMsg, 0) != 0)
+				// ", cancelled"
+			goto LibFail;
+		}
+	else if((flags & IOS_NoDelim) && dputs(text291, rtnMsg, 0) != 0)
 			// " without delimiter at EOF"
 		goto LibFail;
 
@@ -1087,37 +1859,545 @@ int renameFile(Datum *pRtnVal, int n, Datum **args) {
 					// "Disk file", "File", "renamed"
 	}
 
-// Prepare a buffer for reading.  "flags" is passed to bclear().  Return status.
-int readPrep(Buffer *pBuf, ushort flags) {
-
-	if(pBuf->flags & BFCmdFunc)
-		(void) rsset(Failure, RSNoFormat, text344);
-				// "Operation not permitted on a user command or function buffer"
-	else if(bclear(pBuf, flags) == Success) {
-		if(pBuf->flags & BFNarrowed)				// Mark as changed if narrowed.
-			pBuf->flags |= BFChanged;
+// Build absolute pathname of given buffer's file (so that it is still found if the working directory is changed) in heap
+// storage with room for "extra" additional characters, and return it, or NULL if out of memory.
+static char *f_absPath(Buffer *pBuf, size_t extra) {
+	char *pathname;
+	const char *dir = NULL;
+
+	if(*pBuf->filename != '/' && (dir = pBuf->saveDir) == NULL)
+		dir = sess.cur.pScrn->workDir;
+	if((pathname = (char *) malloc((dir == NULL ? 0 : strlen(dir) + 1) + strlen(pBuf->filename) + extra + 1)) != NULL) {
+		if(dir == NULL)
+			strcpy(pathname, pBuf->filename);
+		else
+			sprintf(pathname, "%s/%s", dir, pBuf->filename);
 		}
-	return sess.rtn.status;
+	return pathname;
 	}
 
-// Read a file into the given buffer, blowing away any text found there.  If filename is NULL, use the buffer's filename if set,
-// otherwise standard input.  If RWKeep flag is not set, delete the buffer's filename if set; otherwise, save the filename in
-// the buffer record (if it is not narrowed) and, if RWReadHook flag is set, (a), run the read hook after the file is read; and
-// (b), run the filename hook if the buffer filename was changed.  If RWExist flag is set, return an error if the file does not
-// exist.  If RWStats flag set, set a return message containing input statistics.  Return status, including Cancelled if buffer
-// was not cleared (user did not "okay" it) and IONSF if file does not exist.
-int readIn(Buffer *pBuf, const char *filename, ushort flags) {
-	EWindow *pWind;
-	DataInsert dataInsert = {
-		pBuf,			// Target buffer.
-		&pBuf->face.point,	// Target line.
-		text139			// "Reading data..."
-		};
+// Update hash value with given text (FNV-1a) and return it.
+static ulong f_hash(ulong hash, const char *str, int len) {
+	const char *strEnd = str + len;
 
-	if(readPrep(pBuf, 0) != Success)
-		return sess.rtn.status;					// Error or user got cold feet.
+	while(str < strEnd) {
+		hash ^= (uchar) *str++;
+		hash *= FIHashPrime;
+		}
+	return hash;
+	}
 
-	// Determine filename.
+// Return hash of given line list, beginning at pLine.  If pLineEnd is not NULL, stop after that line (inclusive); otherwise,
+// stop after the last line in the list.
+static ulong f_hashLines(ulong hash, Line *pLine, Line *pLineEnd) {
+
+	for(;;) {
+		hash = f_hash(hash, pLine->text, pLine->used);
+		if(pLine == pLineEnd || (pLine = pLine->next) == NULL)
+			break;
+		hash = f_hash(hash, "\n", 1);
+		}
+	return hash;
+	}
+
+// Return hash of all text in given buffer, including any hidden (narrowed) fragments, with one newline between lines.
+static ulong f_hashBuf(Buffer *pBuf) {
+	ulong hash = FIHashBasis;
+
+	if(pBuf->pNarTopLine != NULL)
+		hash = f_hash(f_hashLines(hash, pBuf->pNarTopLine, pBuf->pNarTopLine->prev), "\n", 1);
+	hash = f_hashLines(hash, pBuf->pFirstLine, NULL);
+	if(pBuf->pNarBotLine != NULL)
+		hash = f_hashLines(f_hash(hash, "\n", 1), pBuf->pNarBotLine, NULL);
+	return hash;
+	}
+
+// Note size, modification time, and text hash of given buffer's file, which was just read or written and matches the buffer,
+// so that reloadBuf() can tell if the file was changed later.  A relative filename is relative to the directory open on dirFD,
+// or the current directory if dirFD is AT_FDCWD.
+static void f_stamp(Buffer *pBuf, int dirFD, const char *filename) {
+	struct stat s;
+
+	if(fstatat(dirFD, filename, &s, 0) != 0)
+		pBuf->statSize = -1;
+	else {
+		pBuf->statSize = s.st_size;
+		pBuf->statTime = s.st_mtime;
+		pBuf->textHash = f_hashBuf(pBuf);
+		}
+	}
+
+// Return true if edits to given buffer are to be journaled.
+static bool f_journaling(Buffer *pBuf) {
+
+	return modeSet(MdIdxJournal, NULL) && pBuf->filename != NULL && !(pBuf->flags & (BFHidden | BFCmdFunc));
+	}
+
+// Create a Journal object for given buffer, noting the size and modification time of the buffer's file as the base of the
+// edits to be recorded, and return it (or NULL if out of memory).  If "snapshot" is true, the buffer does not match its file,
+// so the journal will begin with a snapshot of the buffer.  The journal file is not written until journalFlush() is called.
+static Journal *f_jrnlNew(Buffer *pBuf, bool snapshot) {
+	Journal *pJrnl;
+	struct stat s;
+
+	if((pJrnl = (Journal *) malloc(sizeof(Journal))) == NULL)
+		return NULL;
+	if((pJrnl->pathname = f_absPath(pBuf, sizeof(JournalExt) - 1)) == NULL) {
+		free((void *) pJrnl);
+		return NULL;
+		}
+
+	// Get status of file, then append journal extension to pathname.
+	if(stat(pJrnl->pathname, &s) == 0) {
+		pJrnl->baseSize = s.st_size;
+		pJrnl->baseTime = s.st_mtime;
+		}
+	else {
+		pJrnl->baseSize = -1;
+		pJrnl->baseTime = 0;
+		}
+	strcat(pJrnl->pathname, JournalExt);
+
+	pJrnl->fileSize = -1;
+	pJrnl->buf = NULL;
+	pJrnl->used = pJrnl->size = 0;
+	pJrnl->armed = false;
+	pJrnl->snapshot = snapshot;
+	return pJrnl;
+	}
+
+// Append len bytes to pending records of given journal, copied from str or (if str is NULL) set to character c.  Return zero
+// if successful, otherwise -1.
+static int f_jrnlPut(Journal *pJrnl, const char *str, size_t len, short c) {
+
+	if(pJrnl->used + len > pJrnl->size) {
+		size_t size = (pJrnl->size == 0) ? 256 : pJrnl->size * 2;
+		char *buf;
+
+		while(pJrnl->used + len > size)
+			size *= 2;
+		if((buf = (char *) realloc((void *) pJrnl->buf, size)) == NULL)
+			return -1;
+		pJrnl->buf = buf;
+		pJrnl->size = size;
+		}
+	if(str != NULL)
+		memcpy(pJrnl->buf + pJrnl->used, str, len);
+	else
+		memset(pJrnl->buf + pJrnl->used, c, len);
+	pJrnl->used += len;
+	return 0;
+	}
+
+// Discard pending records of given journal and flag it for a snapshot of its buffer.
+static void f_jrnlReset(Journal *pJrnl) {
+
+	pJrnl->used = 0;
+	pJrnl->snapshot = true;
+	}
+
+// Record a primitive edit of the current edit buffer in its journal if applicable, given point where the edit begins:
+// insertion of len characters (copied from str, or copies of character c if str is NULL), where type is 'I' if newlines in
+// the text split lines and 'C' if they do not; or deletion ('D') of len characters, where each line break counts as one.
+// Must be called before the buffer is changed (and bchange() is called).  Return status.
+int journalEdit(short type, Point *pPoint, long len, const char *str, short c) {
+	Buffer *pBuf = sess.edit.pBuf;
+	Journal *pJrnl = pBuf->pJrnl;
+	char workBuf[48];
+
+	// Start journal if needed (based on buffer's file if buffer has not been changed yet), or end it if "Journal" mode was
+	// disabled.
+	if(pJrnl == NULL) {
+		if(!f_journaling(pBuf))
+			return sess.rtn.status;
+		if((pJrnl = pBuf->pJrnl = f_jrnlNew(pBuf, (pBuf->flags & BFChanged) != 0)) == NULL)
+			goto Fail;
+		}
+	else if(!modeSet(MdIdxJournal, NULL)) {
+		journalEnd(pBuf, true);
+		return sess.rtn.status;
+		}
+
+	// Record edit unless a snapshot is pending or the line number would be relative (buffer is narrowed).  If the last edit
+	// recorded was never made, the journal no longer matches the buffer.
+	if(pJrnl->armed || (pBuf->flags & BFNarrowed))
+		f_jrnlReset(pJrnl);
+	if(!pJrnl->snapshot) {
+		sprintf(workBuf, "%c%ld,%d,%ld\n", (int) type, getLineNum(pBuf, pPoint->pLine), pPoint->offset, len);
+		if(f_jrnlPut(pJrnl, workBuf, strlen(workBuf), 0) != 0 || (type != 'D' && f_jrnlPut(pJrnl, str, len, c) != 0))
+			goto Fail;
+		}
+	pJrnl->armed = true;
+	return sess.rtn.status;
+Fail:
+	return rsset(Panic, 0, text94, "journalEdit");
+			// "%s(): Out of memory!"
+	}
+
+// Note a change to given buffer in its journal (called by bchange()).  If the change was not recorded by journalEdit() just
+// before, flag the journal for a snapshot.  Start a journal if needed.
+void journalChange(Buffer *pBuf) {
+	Journal *pJrnl = pBuf->pJrnl;
+
+	if(pJrnl == NULL) {
+		if(f_journaling(pBuf))
+			pBuf->pJrnl = f_jrnlNew(pBuf, true);
+		}
+	else if(pJrnl->armed)
+		pJrnl->armed = false;
+	else
+		f_jrnlReset(pJrnl);
+	}
+
+// End journaling of given buffer, if applicable.  Delete journal file if "remove" is true.
+void journalEnd(Buffer *pBuf, bool remove) {
+	Journal *pJrnl = pBuf->pJrnl;
+
+	if(pJrnl != NULL) {
+		if(remove && pJrnl->fileSize >= 0)
+			(void) unlink(pJrnl->pathname);
+		free((void *) pJrnl->buf);
+		free((void *) pJrnl->pathname);
+		free((void *) pJrnl);
+		pBuf->pJrnl = NULL;
+		}
+	}
+
+// Write a snapshot record of given buffer to given output stream: line count followed by the length and text of each line.
+// Return zero if successful, otherwise -1.
+static int f_jrnlSnap(OtpStream *pStream, Buffer *pBuf) {
+	char workBuf[24];
+	Line *pLine = pBuf->pFirstLine;
+
+	sprintf(workBuf, "S%ld\n", pBuf->lineTotal);
+	if(f_write(pStream, workBuf, strlen(workBuf)) != 0)
+		return -1;
+	do {
+		sprintf(workBuf, "%d\n", pLine->used);
+		if(f_write(pStream, workBuf, strlen(workBuf)) != 0 || f_write(pStream, pLine->text, pLine->used) != 0)
+			return -1;
+		} while((pLine = pLine->next) != NULL);
+	return 0;
+	}
+
+// Rewrite journal file of given buffer: a header line followed by a snapshot of the buffer if "snapshot" is true, otherwise
+// the pending records.  A temporary file is written and renamed to the journal, so that a crash cannot destroy the existing
+// journal.  Return status.
+static int f_jrnlWrite(Buffer *pBuf, bool snapshot) {
+	int fileHandle, errNum = 0;
+	Journal *pJrnl = pBuf->pJrnl;
+	char workBuf[sizeof(FIJrnlMagic) + 48];
+	char tempName[strlen(pJrnl->pathname) + 2];
+
+	sprintf(tempName, "%s~", pJrnl->pathname);
+	if((fileHandle = open(tempName, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1)
+		return rsset(Failure, RSHigh, text141, strerror(errno), tempName);
+				// "I/O Error: %s, file \"%s\""
+	f_sopen(&otpStream, fileHandle, false);
+	sprintf(workBuf, "%s %jd %jd\n", FIJrnlMagic, (intmax_t) pJrnl->baseSize, (intmax_t) pJrnl->baseTime);
+	if(f_write(&otpStream, workBuf, strlen(workBuf)) != 0 || (snapshot ? f_jrnlSnap(&otpStream, pBuf) :
+	 f_write(&otpStream, pJrnl->buf, pJrnl->used)) != 0 || f_flush(&otpStream) != 0)
+		errNum = otpStream.errNum;
+	if(close(fileHandle) != 0 && errNum == 0)
+		errNum = errno;
+	if(errNum == 0 && rename(tempName, pJrnl->pathname) != 0)
+		errNum = errno;
+	if(errNum != 0) {
+		(void) unlink(tempName);
+		return rsset(Failure, RSHigh, text141, strerror(errNum), pJrnl->pathname);
+		}
+
+	pJrnl->fileSize = otpStream.count;
+	pJrnl->used = 0;
+	pJrnl->snapshot = false;
+	return sess.rtn.status;
+	}
+
+// Append pending records of given journal to its file.  Return status.
+static int f_jrnlAppend(Journal *pJrnl) {
+	int fileHandle, errNum = 0;
+
+	if((fileHandle = open(pJrnl->pathname, O_WRONLY | O_APPEND)) == -1)
+		errNum = errno;
+	else {
+		f_sopen(&otpStream, fileHandle, false);
+		if(f_write(&otpStream, pJrnl->buf, pJrnl->used) != 0 || f_flush(&otpStream) != 0)
+			errNum = otpStream.errNum;
+		if(close(fileHandle) != 0 && errNum == 0)
+			errNum = errno;
+		}
+	if(errNum != 0) {
+
+		// Journal file can no longer be trusted... rewrite it next time.
+		f_jrnlReset(pJrnl);
+		return rsset(Failure, RSHigh, text141, strerror(errNum), pJrnl->pathname);
+				// "I/O Error: %s, file \"%s\""
+		}
+
+	pJrnl->fileSize += otpStream.count;
+	pJrnl->used = 0;
+	return sess.rtn.status;
+	}
+
+// Write pending edit records of all journaled buffers to their journal files (at auto-save time in "Journal" mode) and reset
+// the auto-save counter.  A journal file is rewritten with a snapshot of its buffer instead if an unrecorded change was made or
+// the file would grow larger than both the buffer text and FIJrnlCompact bytes, which compacts it.  Narrowed buffers are
+// skipped until they are widened.  Return status.
+int journalFlush(void) {
+	Datum **ppBufItem, **ppBufItemEnd;
+	Buffer *pBuf;
+	Journal *pJrnl;
+	off_t size;
+
+	sess.autoSaveCount = sess.autoSaveTrig;
+	ppBufItemEnd = (ppBufItem = bufTable.elements) + bufTable.used;
+	for(; ppBufItem < ppBufItemEnd; ++ppBufItem) {
+		pBuf = bufPtr(*ppBufItem);
+		if((pJrnl = pBuf->pJrnl) == NULL || (pBuf->flags & BFNarrowed))
+			continue;
+		if(!(pBuf->flags & BFChanged))
+			journalEnd(pBuf, true);			// Buffer matches its file again.
+		else {
+			size = (pJrnl->fileSize < 0 ? 0 : pJrnl->fileSize) + pJrnl->used;
+			if(pJrnl->snapshot || (size > FIJrnlCompact && size > pBuf->byteTotal + pBuf->lineTotal))
+				(void) f_jrnlWrite(pBuf, true);
+			else if(pJrnl->fileSize < 0)
+				(void) f_jrnlWrite(pBuf, false);
+			else if(pJrnl->used > 0)
+				(void) f_jrnlAppend(pJrnl);
+			}
+		}
+
+	return sess.rtn.status;
+	}
+
+// Get a decimal number terminated by given character from journal text at *pStr (ending at strEnd) and advance *pStr past the
+// terminator.  Return true if successful, otherwise false.
+static bool f_jrnlNum(const char **pStr, const char *strEnd, short term, long *pNum) {
+	const char *str = *pStr;
+	bool minus = false;
+	long n = 0;
+
+	if(str < strEnd && *str == '-') {
+		minus = true;
+		++str;
+		}
+	if(str == strEnd || *str < '0' || *str > '9')
+		return false;
+	do {
+		n = n * 10 + (*str++ - '0');
+		} while(str < strEnd && *str >= '0' && *str <= '9');
+	if(str == strEnd || *str != term)
+		return false;
+	*pStr = str + 1;
+	*pNum = minus ? -n : n;
+	return true;
+	}
+
+// Replay the edits in given journal text (ending at strEnd) over given buffer, which must be the current edit buffer.  Set
+// *pEditCt to the number of edits applied.  Return true if the entire journal was applied, otherwise false (journal is
+// incomplete or does not match the buffer).
+static bool f_jrnlReplay(Buffer *pBuf, const char *str, const char *strEnd, uint *pEditCt) {
+	long lineNum, offset, len;
+	short type;
+	Line *pLine;
+	Point *pPoint = &sess.edit.pFace->point;
+
+	while(str < strEnd) {
+		if((type = *str++) == 'S') {
+
+			// Snapshot: delete all text in buffer, then insert each line.
+			if(!f_jrnlNum(&str, strEnd, '\n', &lineNum) || lineNum < 1)
+				return false;
+			pPoint->pLine = pBuf->pFirstLine;
+			pPoint->offset = 0;
+			if(edelc(LONG_MAX, 0) < NotFound)
+				return false;
+
+			// The edit face is not in the buffer's window registry, so it is not updated by the edit routines.  Move it
+			// to end of buffer before each insertion.
+			do {
+				if(!f_jrnlNum(&str, strEnd, '\n', &len) || len < 0 || len > strEnd - str)
+					return false;
+				pPoint->offset = (pPoint->pLine = pBuf->pFirstLine->prev)->used;
+				if(einsertBlk(str, len, true) != Success)
+					return false;
+				str += len;
+				if(lineNum > 1) {
+					pPoint->offset = (pPoint->pLine = pBuf->pFirstLine->prev)->used;
+					if(einsertNL() != Success)
+						return false;
+					}
+				} while(--lineNum > 0);
+			}
+		else {
+			// Insertion or deletion at a position.
+			if((type != 'I' && type != 'C' && type != 'D') || !f_jrnlNum(&str, strEnd, ',', &lineNum) ||
+			 !f_jrnlNum(&str, strEnd, ',', &offset) || !f_jrnlNum(&str, strEnd, '\n', &len) || len < 0 ||
+			 (pLine = getLinePtr(pBuf, lineNum)) == NULL || offset < 0 || offset > pLine->used)
+				return false;
+			pPoint->pLine = pLine;
+			pPoint->offset = offset;
+			if(type == 'D') {
+				if(edelc(len, 0) != Success)
+					return false;
+				}
+			else {
+				if(len > strEnd - str || einsertBlk(str, len, type == 'C') != Success)
+					return false;
+				str += len;
+				}
+			}
+		++*pEditCt;
+		}
+	return true;
+	}
+
+// Recover edits made in a session that ended abnormally: replay the journal of given buffer's file over the buffer (which was
+// just read from the file), if one exists and does not belong to a buffer in this session.  The journal is applied only if the
+// size and modification time of the file have not changed since the journal was started and the user confirms it (in
+// interactive mode).  Journaling then continues in the same journal file.  Return status.
+static int f_jrnlRecover(Buffer *pBuf, const char *filename) {
+	int fileHandle;
+	ssize_t n;
+	size_t size, len;
+	struct stat s, s1;
+	char *buf;
+	const char *str, *strEnd;
+	long baseSize, baseTime;
+	bool complete;
+	uint editCt = 0;
+	Journal *pJrnl;
+	Face face;
+	BufCtrl oldEdit;
+	ushort oldFlags;
+	Datum **ppBufItem, **ppBufItemEnd;
+	char pathname[strlen(filename) + sizeof(JournalExt)];
+
+	sprintf(pathname, "%s%s", filename, JournalExt);
+	if((fileHandle = open(pathname, O_RDONLY)) == -1)
+		return sess.rtn.status;				// No journal.
+	if(fstat(fileHandle, &s) != 0 || s.st_size == 0)
+		goto Close;
+
+	// Skip journal if it belongs to another buffer.
+	ppBufItemEnd = (ppBufItem = bufTable.elements) + bufTable.used;
+	for(; ppBufItem < ppBufItemEnd; ++ppBufItem)
+		if((pJrnl = bufPtr(*ppBufItem)->pJrnl) != NULL && pJrnl->fileSize >= 0 && stat(pJrnl->pathname, &s1) == 0 &&
+		 s1.st_dev == s.st_dev && s1.st_ino == s.st_ino)
+			goto Close;
+
+	// Read journal into memory.
+	if((buf = (char *) malloc(s.st_size)) == NULL) {
+		(void) close(fileHandle);
+		return rsset(Panic, 0, text94, "f_jrnlRecover");
+				// "%s(): Out of memory!"
+		}
+	size = 0;
+	while(size < (size_t) s.st_size && (n = read(fileHandle, buf + size, s.st_size - size)) > 0)
+		size += n;
+	(void) close(fileHandle);
+
+	// Check header and base file.
+	strEnd = buf + size;
+	len = strlen(FIJrnlMagic);
+	str = buf + len + 1;
+	if(size <= len || memcmp(buf, FIJrnlMagic, len) != 0 || buf[len] != ' ' ||
+	 !f_jrnlNum(&str, strEnd, ' ', &baseSize) || !f_jrnlNum(&str, strEnd, '\n', &baseTime)) {
+		(void) rsset(Success, RSHigh | RSForce, text506, pathname, text508);
+				// "Journal \"%s\" not applied: %s", "journal is damaged"
+		goto Free;
+		}
+	if(stat(filename, &s1) == 0 ? s1.st_size != baseSize || s1.st_mtime != baseTime : baseSize != -1) {
+		(void) rsset(Success, RSHigh | RSForce, text506, pathname, text507);
+				// "Journal \"%s\" not applied: %s", "file was changed after journal was started"
+		goto Free;
+		}
+
+	// Get user confirmation.  Journal is not applied if terminal is not open.
+	if(!(sess.opFlags & OpVTermOpen))
+		goto Free;
+	else {
+		bool yep;
+		char prompt[strlen(text513) + strlen(pathname)];
+
+		sprintf(prompt, text513, pathname);
+				// "Recover edits from journal \"%s\""
+		if(terminpYN(prompt, &yep) != Success || !yep)
+			goto Free;
+		}
+
+	// Make buffer the current edit buffer with a private face, lift any read-only restriction, and replay the journal.
+	oldEdit = sess.edit;
+	oldFlags = pBuf->flags;
+	sess.edit.pBuf = pBuf;
+	faceInit(sess.edit.pFace = &face, pBuf->pFirstLine, NULL);
+	sess.edit.pScrn = (EScreen *) (sess.edit.pWind = NULL);
+	pBuf->flags &= ~BFReadOnly;
+	complete = f_jrnlReplay(pBuf, str, strEnd, &editCt);
+	sess.edit = oldEdit;
+	pBuf->flags |= oldFlags & BFReadOnly;
+	if(sess.rtn.status <= FatalError)
+		goto Free;
+
+	// Continue journaling in recovered file (instead of any journal begun by the replay).  If the journal was not complete
+	// (because the session ended while it was being written), it will be rewritten.
+	journalEnd(pBuf, false);
+	if(editCt == 0)
+		(void) rsset(Success, RSHigh | RSForce, text506, pathname, text508);
+				// "Journal \"%s\" not applied: %s", "journal is damaged"
+	else {
+		if((pJrnl = pBuf->pJrnl = f_jrnlNew(pBuf, !complete)) == NULL) {
+			free((void *) buf);
+			return rsset(Panic, 0, text94, "f_jrnlRecover");
+			}
+		pJrnl->baseSize = baseSize;
+		pJrnl->baseTime = baseTime;
+		pJrnl->fileSize = size;
+		(void) rsset(Success, RSHigh | RSForce, text505, editCt, editCt != 1 ? "s" : "", pathname);
+				// "Recovered %u edit%s from journal \"%s\""
+		}
+Free:
+	free((void *) buf);
+	return sess.rtn.status;
+Close:
+	(void) close(fileHandle);
+	return sess.rtn.status;
+	}
+
+// Prepare a buffer for reading.  "flags" is passed to bclear().  Return status.
+int readPrep(Buffer *pBuf, ushort flags) {
+
+	if(pBuf->flags & BFCmdFunc)
+		(void) rsset(Failure, RSNoFormat, text344);
+				// "Operation not permitted on a user command or function buffer"
+	else if(bclear(pBuf, flags) == Success) {
+		if(pBuf->flags & BFNarrowed)				// Mark as changed if narrowed.
+			pBuf->flags |= BFChanged;
+		}
+	return sess.rtn.status;
+	}
+
+// Read a file into the given buffer, blowing away any text found there.  If filename is NULL, use the buffer's filename if set,
+// otherwise standard input.  If RWKeep flag is not set, delete the buffer's filename if set; otherwise, save the filename in
+// the buffer record (if it is not narrowed) and, if RWReadHook flag is set, (a), run the read hook after the file is read; and
+// (b), run the filename hook if the buffer filename was changed.  If RWExist flag is set, return an error if the file does not
+// exist.  If RWStats flag set, set a return message containing input statistics.  Return status, including Cancelled if buffer
+// was not cleared (user did not "okay" it) and IONSF if file does not exist.
+int readIn(Buffer *pBuf, const char *filename, ushort flags) {
+	EWindow *pWind;
+	DataInsert dataInsert = {
+		pBuf,			// Target buffer.
+		&pBuf->face.point,	// Target line.
+		text139			// "Reading data..."
+		};
+
+	if(readPrep(pBuf, 0) != Success)
+		return sess.rtn.status;					// Error or user got cold feet.
+
+	// Determine filename.
+	pBuf->readSize = 0;
+	pBuf->statSize = -1;
 	if(filename == NULL)
 		filename = pBuf->filename;
 	else if((flags & RWKeep) && !(pBuf->flags & BFNarrowed) &&
@@ -1130,10 +2410,16 @@ int readIn(Buffer *pBuf, const char *filename, ushort flags) {
 	if(dataInsert.status != Success)
 		goto Retn;
 
-	// Read the file and "unchange" the buffer.
+	// Read the file and "unchange" the buffer.  If user cancelled the read, make the buffer read-only so that the partial text
+	// is not written over the file by mistake.
 	if(insertData(1, NULL, &dataInsert) != Success)
 		return sess.rtn.status;
 	pBuf->flags &= ~BFChanged;
+	if(dataInsert.status == UserAbort)
+		pBuf->flags |= BFReadOnly;
+	pBuf->readSize = fileInfo.inpOffset - (fileInfo.ioBufEnd - fileInfo.ioBufCur);
+	if((flags & RWKeep) && dataInsert.status == Success && !(pBuf->flags & BFNarrowed))
+		f_stamp(pBuf, AT_FDCWD, filename);
 
 	// Report results.
 	if(flags & RWStats) {
@@ -1149,6 +2435,7 @@ int readIn(Buffer *pBuf, const char *filename, ushort flags) {
 Retn:
 	// Make sure buffer is flagged as active.
 	pBuf->flags |= BFActive;
+	pBuf->lastUse = ++sess.useClock;
 
 	// Update buffer and window pointers.
 	faceInit(&pBuf->face, pBuf->pFirstLine, pBuf);
@@ -1160,6 +2447,13 @@ Retn:
 			}
 		} while((pWind = pWind->next) != NULL);
 
+	// Discard buffer's edit journal (the buffer was re-read), then recover edits from the file's journal if one was left by a
+	// session that ended abnormally.
+	journalEnd(pBuf, true);
+	if((flags & RWKeep) && !(pBuf->flags & BFNarrowed) && f_journaling(pBuf) &&
+	 (dataInsert.status == Success || dataInsert.status == IONSF) && f_jrnlRecover(pBuf, filename) <= FatalError)
+		return sess.rtn.status;
+
 	// Erase filename and run read hook if requested.
 	if(!(flags & RWKeep))
 		clearBufFilename(pBuf);
@@ -1167,8 +2461,14 @@ Retn:
 		if(execHook(NULL, INT_MIN, hookTable + HkRead, 2, pBuf->bufname, pBuf->filename) <= FatalError)
 			return sess.rtn.status;
 
+	// Keep buffer memory within budget.  Eviction is done between commands by editLoop() so that no buffer is evicted
+	// while a running script may still be referencing it.
+	if(dataInsert.status >= Success && sess.bufMemLimit > 0)
+		sess.opFlags |= OpEvict;
+
 	// Return status.
-	return (dataInsert.status == IONSF) ? rsset(Success, RSHigh | RSNoFormat, text138) : mlerase(0);
+	return (dataInsert.status == IONSF && !(pBuf->flags & BFChanged)) ? rsset(Success, RSHigh | RSNoFormat, text138) :
+	 mlerase(0);
 							// "New file"
 	}
 
@@ -1236,6 +2536,716 @@ int insertFile(Datum *pRtnVal, int n, Datum **args) {
 	return sess.rtn.status;
 	}
 
+// Set an inotify watch on followed file, creating the inotify instance if needed.  The watch only serves to wake up
+// followWait() promptly; if it cannot be set, the file is still checked every FIFollowPoll milliseconds.
+static void f_followWatch(Follow *pFollow) {
+
+#if LINUX
+	if(followFd < 0)
+		followFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(followFd >= 0)
+		pFollow->watch = inotify_add_watch(followFd, pFollow->pathname,
+		 IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+#endif
+	}
+
+// Remove inotify watch of given followed buffer, if any.  The watch is left in place if another followed buffer is sharing it
+// (inotify returns the same watch descriptor for the same file).
+static void f_followUnwatch(Buffer *pBuf) {
+	Follow *pFollow = pBuf->pFollow;
+
+	if(pFollow->watch >= 0) {
+		Buffer *pBuf1;
+		Datum **ppBufItem = bufTable.elements;
+		Datum **ppBufItemEnd = ppBufItem + bufTable.used;
+
+		do {
+			pBuf1 = bufPtr(*ppBufItem);
+			if(pBuf1 != pBuf && pBuf1->pFollow != NULL && pBuf1->pFollow->watch == pFollow->watch)
+				goto Retn;
+			} while(++ppBufItem < ppBufItemEnd);
+#if LINUX
+		(void) inotify_rm_watch(followFd, pFollow->watch);
+#endif
+Retn:
+		pFollow->watch = -1;
+		}
+	}
+
+// Record current identity and size of followed file so that only data appended from now on is added to the buffer.  Called
+// after the buffer was written to the file.
+static void f_followSync(Buffer *pBuf) {
+	struct stat s;
+	Follow *pFollow = pBuf->pFollow;
+
+	if(stat(pFollow->pathname, &s) == 0) {
+		if(s.st_dev != pFollow->dev || s.st_ino != pFollow->ino) {
+			f_followUnwatch(pBuf);
+			pFollow->dev = s.st_dev;
+			pFollow->ino = s.st_ino;
+			f_followWatch(pFollow);
+			}
+		pFollow->pos = s.st_size;
+		}
+	}
+
+// Start following given buffer's file.  Data subsequently appended to the file is added to the end of the buffer by
+// followWait() while the editor is waiting for a keystroke.  Return status.
+int followBuf(Buffer *pBuf) {
+	int fileHandle;
+	struct stat s;
+	Follow *pFollow;
+	char *pathname;
+
+	// Check if buffer can be followed.
+	if(pBuf->flags & BFCmdFunc)
+		return rsset(Failure, 0, text344, text376);
+			// "Operation not permitted on a %s buffer", "user command or function"
+	if(pBuf->filename == NULL)
+		return rsset(Failure, 0, text493, text83, pBuf->bufname);
+			// "No filename set for %s '%s'", "buffer"
+	if(bactivate(pBuf) != Success)
+		return sess.rtn.status;
+
+	// Get absolute pathname of file.
+	if((pathname = f_absPath(pBuf, 0)) == NULL)
+		return rsset(Panic, 0, text94, "followBuf");
+			// "%s(): Out of memory!"
+	if(stat(pathname, &s) != 0) {
+		(void) rsset(Failure, 0, text141, strerror(errno), pathname);
+				// "I/O Error: %s, file \"%s\""
+		free((void *) pathname);
+		return sess.rtn.status;
+		}
+
+	// Refuse a compressed file: it is not appended to as it grows and the buffer's read offset is not a file offset.
+	if((fileHandle = open(pathname, O_RDONLY)) != -1) {
+		bool compressed = f_gzip(fileHandle);
+
+		(void) close(fileHandle);
+		if(compressed) {
+			free((void *) pathname);
+			return rsset(Failure, 0, text344, text514);
+				// "Operation not permitted on a %s buffer", "compressed file"
+			}
+		}
+
+	// Create Follow object and begin at the point in the file where the last read left off.
+	if((pFollow = (Follow *) malloc(sizeof(Follow))) == NULL) {
+		free((void *) pathname);
+		return rsset(Panic, 0, text94, "followBuf");
+		}
+	pFollow->pathname = pathname;
+	pFollow->watch = -1;
+	pFollow->pos = pBuf->readSize;
+	pFollow->dev = s.st_dev;
+	pFollow->ino = s.st_ino;
+	pBuf->pFollow = pFollow;
+	++followCount;
+	f_followWatch(pFollow);
+
+	return sess.rtn.status;
+	}
+
+// Stop following given buffer's file, if applicable, and release follow-mode storage.
+void followEnd(Buffer *pBuf) {
+	Follow *pFollow = pBuf->pFollow;
+
+	if(pFollow != NULL) {
+		f_followUnwatch(pBuf);
+		free((void *) pFollow->pathname);
+		free((void *) pFollow);
+		pBuf->pFollow = NULL;
+		if(--followCount == 0 && followFd >= 0) {
+			(void) close(followFd);
+			followFd = -1;
+			}
+		}
+	pBuf->flags &= ~BFFollow;
+	}
+
+// Stop following given buffer's file for given reason and notify user.  Return status.
+static int f_followStop(Buffer *pBuf, const char *reason) {
+
+	followEnd(pBuf);
+	return mlprintf(MLHome | MLFlush, text501, text83, pBuf->bufname, reason);
+		// "Stopped following %s '%s': %s", "buffer"
+	}
+
+// Move given edit face to end of current edit buffer and return it.  (The face is not in the buffer's window registry, so it
+// is not updated by the edit routines and must be repositioned before each insertion.)
+static Face *f_followEOB(Face *pFace) {
+	Line *pLine = sess.edit.pBuf->pFirstLine->prev;
+
+	pFace->point.pLine = pLine;
+	pFace->point.offset = pLine->used;
+	return pFace;
+	}
+
+// Insert a line of text at end of current edit buffer via given edit face, followed by a line break if addNL is true.  The
+// text is inserted literally.  Return status.
+static int f_followIns(Face *pFace, const char *text, int len, bool addNL) {
+
+	(void) f_followEOB(pFace);
+	if(einsertBlk(text, len, true) == Success && addNL) {
+		(void) f_followEOB(pFace);
+		(void) einsertNL();
+		}
+	return sess.rtn.status;
+	}
+
+// Append data in followed buffer's file from last position up to given size to end of buffer, splitting it into lines per
+// buffer's input delimiter(s).  Data is read in blocks, so time spent is proportional to the amount of new data only.  If the
+// data ends with the first byte of a two-byte delimiter, that byte is left for the next call.  Windows whose point is at end
+// of buffer move with the inserted text, so they keep showing the tail of the file.  The read-only and changed attributes of
+// the buffer are not affected.  Set *pChanged to true if any data was appended.  Return status.
+static int f_followAppend(Buffer *pBuf, off_t size, bool *pChanged) {
+	int fileHandle;
+	ssize_t n;
+	char *str, *str1, *strEnd, *scan;
+	const char *delim;
+	ushort delimLen;
+	Face face;
+	BufCtrl oldEdit = sess.edit;
+	ushort oldFlags = pBuf->flags;
+	Follow *pFollow = pBuf->pFollow;
+
+	if((fileHandle = open(pFollow->pathname, O_RDONLY)) == -1)
+		return f_followStop(pBuf, strerror(errno));
+
+	// Get line delimiter(s) of buffer.
+	if((delimLen = pBuf->inpDelim.len) == 0) {
+		delim = "\n";
+		delimLen = 1;
+		}
+	else
+		delim = pBuf->inpDelim.u.delim;
+
+	// Make buffer the current edit buffer with a private face, and lift any read-only restriction while appending.
+	sess.edit.pBuf = pBuf;
+	faceInit(sess.edit.pFace = &face, pBuf->pFirstLine, NULL);
+	sess.edit.pScrn = (EScreen *) (sess.edit.pWind = NULL);
+	pBuf->flags &= ~BFReadOnly;
+
+	// Read and insert blocks until new data is exhausted.
+	while(pFollow->pos < size) {
+		if((n = pread(fileHandle, fileInfo.dataBuf, size - pFollow->pos < FIFileBufSize ?
+		 (size_t) (size - pFollow->pos) : FIFileBufSize, pFollow->pos)) <= 0) {
+			if(n < 0)
+				(void) f_followStop(pBuf, strerror(errno));
+			break;
+			}
+		strEnd = (str = fileInfo.dataBuf) + n;
+		if(delimLen == 1 && *delim == '\n') {
+
+			// Newline-delimited file: insert whole block.
+			(void) f_followEOB(&face);
+			if(einsertBlk(str, n, false) != Success)
+				break;
+			}
+		else {
+			// Insert each complete line, then any trailing partial line.
+			scan = str;
+			while((str1 = memchr(scan, delim[0], strEnd - scan)) != NULL) {
+				if(delimLen == 2) {
+					if(str1 + 1 == strEnd) {
+
+						// Partial delimiter at end of block: leave it for next read.
+						strEnd = str1;
+						break;
+						}
+					if(str1[1] != delim[1]) {
+						scan = str1 + 1;
+						continue;
+						}
+					}
+				if(f_followIns(&face, str, str1 - str, true) != Success)
+					goto Retn;
+				scan = str = str1 + delimLen;
+				}
+			if(str < strEnd && f_followIns(&face, str, strEnd - str, false) != Success)
+				break;
+			}
+		if(strEnd == fileInfo.dataBuf)
+			break;
+		pFollow->pos += strEnd - fileInfo.dataBuf;
+		*pChanged = true;
+		}
+Retn:
+	(void) close(fileHandle);
+
+	// Restore edit buffer and attributes.
+	sess.edit = oldEdit;
+	if((pBuf->flags & BFChanged) != (oldFlags & BFChanged))
+		supd_windFlags(pBuf, WFMode);
+	pBuf->flags = (pBuf->flags & ~(BFChanged | BFReadOnly)) | (oldFlags & (BFChanged | BFReadOnly));
+	return sess.rtn.status;
+	}
+
+// Bring given followed buffer up to date with its file.  If the file was truncated or replaced (rotated), the buffer is cleared
+// and refilled from the beginning of the (new) file, unless it was changed by the user, in which case following is stopped.
+// Set *pChanged to true if buffer was modified.  Return status.
+static int f_followUpdate(Buffer *pBuf, bool *pChanged) {
+	struct stat s;
+	Follow *pFollow = pBuf->pFollow;
+
+	// Skip buffer if narrowed or file is missing (possibly in the middle of being rotated).
+	if((pBuf->flags & BFNarrowed) || stat(pFollow->pathname, &s) != 0)
+		return sess.rtn.status;
+
+	// File truncated or replaced?
+	if(s.st_dev != pFollow->dev || s.st_ino != pFollow->ino || s.st_size < pFollow->pos) {
+		LineDelim inpDelim = pBuf->inpDelim;
+
+		if(pBuf->flags & BFChanged)
+			return f_followStop(pBuf, text502);
+				// "file was truncated or replaced"
+		if(bclear(pBuf, 0) != Success)
+			return sess.rtn.status;
+		pBuf->inpDelim = inpDelim;
+		*pChanged = true;
+		if(s.st_dev != pFollow->dev || s.st_ino != pFollow->ino) {
+			f_followUnwatch(pBuf);
+			pFollow->dev = s.st_dev;
+			pFollow->ino = s.st_ino;
+			f_followWatch(pFollow);
+			}
+		pFollow->pos = 0;
+		}
+
+	return (s.st_size > pFollow->pos) ? f_followAppend(pBuf, s.st_size, pChanged) : sess.rtn.status;
+	}
+
+// Wait for a keystroke while one or more buffers are being followed.  Whenever a followed file changes (or every FIFollowPoll
+// milliseconds), bring the followed buffers up to date and update the display.  Return status when a keystroke is ready or
+// immediately if no buffer is being followed or input is already pending.
+int followWait(void) {
+	int count;
+	bool changed;
+	Buffer *pBuf;
+	Datum **ppBufItem, **ppBufItemEnd;
+#if LINUX
+	char eventBuf[4096];
+#endif
+
+	while(followCount > 0) {
+		if(keyEntry.isPending || curMacro.state == MacPlay || typahead(&count) != Success || count > 0 ||
+		 tready(followFd, FIFollowPoll))
+			break;
+#if LINUX
+		// Discard inotify events.  All followed files are checked below, so the event details are not needed.
+		if(followFd >= 0)
+			while(read(followFd, eventBuf, sizeof(eventBuf)) > 0);
+#endif
+		changed = false;
+		ppBufItemEnd = (ppBufItem = bufTable.elements) + bufTable.used;
+		do {
+			pBuf = bufPtr(*ppBufItem);
+			if(pBuf->pFollow != NULL && f_followUpdate(pBuf, &changed) != Success) {
+				if(sess.rtn.status <= MinExit)
+					return sess.rtn.status;
+
+				// Non-fatal error: stop following buffer and report it.
+				(void) f_followStop(pBuf, sess.rtn.msg.str);
+				rsclear(0);
+				}
+			} while(++ppBufItem < ppBufItemEnd);
+		if(changed && update(INT_MIN) <= MinExit)
+			break;
+		}
+
+	return sess.rtn.status;
+	}
+
+// Create array of DiffLine objects for count lines beginning at pLine and return it, or NULL if out of memory.
+static struct DiffLine *f_diffLoad(Line *pLine, long count) {
+	struct DiffLine *lines, *pDiffLine;
+
+	if((lines = (struct DiffLine *) malloc(sizeof(struct DiffLine) * (count > 0 ? count : 1))) != NULL)
+		for(pDiffLine = lines; count-- > 0; ++pDiffLine) {
+			pDiffLine->pLine = pLine;
+			pDiffLine->hash = f_hash(FIHashBasis, pLine->text, pLine->used);
+			pLine = pLine->next;
+			}
+	return lines;
+	}
+
+// Return true if given lines are identical, otherwise false.
+static bool f_diffEq(struct DiffLine *pDiffLine1, struct DiffLine *pDiffLine2) {
+
+	return pDiffLine1->hash == pDiffLine2->hash && pDiffLine1->pLine->used == pDiffLine2->pLine->used &&
+	 memcmp(pDiffLine1->pLine->text, pDiffLine2->pLine->text, pDiffLine1->pLine->used) == 0;
+	}
+
+// Move point of current edit face to given line number and offset in current edit buffer.  (The face is not in the buffer's
+// window registry, so it is not updated by the edit routines and must be repositioned before each edit.)
+static void f_diffPoint(long lineNum, int offset) {
+	Point *pPoint = &sess.edit.pFace->point;
+
+	pPoint->pLine = getLinePtr(sess.edit.pBuf, lineNum);
+	pPoint->offset = offset;
+	}
+
+// Replace lines a1 through a2 - 1 of the current edit buffer with lines b1 through b2 - 1 of the new text, given diff control
+// object.  Changes must be applied from the bottom of the buffer up so that the line numbers of earlier changes stay valid.
+// Return status.
+static int f_diffApply(DiffCtrl *pCtrl, long a1, long a2, long b1, long b2) {
+	long i, lineNum;
+	int offset;
+	long delLen = 0;
+	size_t insLen = 0;
+	char *str;
+	Line *pLine;
+	bool byLine = false;
+
+	// The last line of the buffer has no newline, so a change that extends to the end of the buffer ("tail" change) begins
+	// at the end of the line before it with each line preceded by a newline instead, or at the beginning of the buffer with
+	// newlines between lines only.
+	bool tail = (a2 == pCtrl->aCt);
+
+	// Get length of old text and size of new text.
+	for(i = a1; i < a2; ++i)
+		delLen += pCtrl->a[i].pLine->used + 1;
+	if(tail && a1 == 0)
+		--delLen;
+	for(i = b1; i < b2; ++i)
+		insLen += pCtrl->b[i].pLine->used + 1;
+
+	// If new text is too long to insert in one step, insert the lines one at a time.
+	if(insLen > INT_MAX) {
+		byLine = true;
+		goto Edit;
+		}
+	if(insLen > pCtrl->bufSize) {
+		if((str = (char *) realloc((void *) pCtrl->buf, insLen)) == NULL)
+			return rsset(Panic, 0, text94, "f_diffApply");
+				// "%s(): Out of memory!"
+		pCtrl->buf = str;
+		pCtrl->bufSize = insLen;
+		}
+
+	// Build new text and note if any line contains a literal newline.
+	str = pCtrl->buf;
+	for(i = b1; i < b2; ++i) {
+		pLine = pCtrl->b[i].pLine;
+		if(tail && (a1 > 0 || i > b1))
+			*str++ = '\n';
+		memcpy(str, pLine->text, pLine->used);
+		str += pLine->used;
+		if(!tail)
+			*str++ = '\n';
+		if(memchr(pLine->text, '\n', pLine->used) != NULL)
+			byLine = true;
+		}
+	insLen = str - pCtrl->buf;
+
+	// Position point, delete old text, and insert new text.  If any new line contains a literal newline, insert the lines one
+	// at a time.
+Edit:
+	if(tail && a1 > 0) {
+		lineNum = a1;
+		offset = pCtrl->a[a1 - 1].pLine->used;
+		}
+	else {
+		lineNum = a1 + 1;
+		offset = 0;
+		}
+	f_diffPoint(lineNum, offset);
+	if(delLen > 0 && edelc(delLen, 0) != Success)
+		return sess.rtn.status;
+	if(!byLine) {
+		if(insLen > 0) {
+			f_diffPoint(lineNum, offset);
+			if(einsertBlk(pCtrl->buf, insLen, false) != Success)
+				return sess.rtn.status;
+			}
+		}
+	else
+		for(i = b1; i < b2; ++i) {
+			pLine = pCtrl->b[i].pLine;
+			if(tail && (a1 > 0 || i > b1)) {
+				f_diffPoint(lineNum++, offset);
+				if(einsertNL() != Success)
+					return sess.rtn.status;
+				offset = 0;
+				}
+			f_diffPoint(lineNum, offset);
+			if(einsertBlk(pLine->text, pLine->used, true) != Success)
+				return sess.rtn.status;
+			offset += pLine->used;
+			if(!tail) {
+				f_diffPoint(lineNum++, offset);
+				if(einsertNL() != Success)
+					return sess.rtn.status;
+				offset = 0;
+				}
+			}
+	++pCtrl->changeCt;
+	return sess.rtn.status;
+	}
+
+// Find the differences between lines aLo through aHi - 1 of the buffer and lines bLo through bHi - 1 of the new text with the
+// Myers O(ND) algorithm and apply them to the current edit buffer, last one first.  If more than FIDiffMax line edits are
+// needed, the whole range is replaced instead.  Return status.
+static int f_diffRange(DiffCtrl *pCtrl, long aLo, long aHi, long bLo, long bHi) {
+	long n = aHi - aLo;
+	long m = bHi - bLo;
+	long maxD, d, k, x, y, prevK, midX;
+	long *v, *pv, *trace = NULL;
+	long traceSize = 0;
+	long hunk[4];
+	bool open = false;
+
+	if(n == 0 || m == 0)
+		return f_diffApply(pCtrl, aLo, aHi, bLo, bHi);
+
+	// Forward pass: find furthest reaching path for each edit count d, saving each diagonal vector V (of size 2d + 1) at
+	// offset d * d in trace array.
+	maxD = (n + m < FIDiffMax) ? n + m : FIDiffMax;
+	if((v = (long *) malloc(sizeof(long) * (2 * maxD + 3))) == NULL)
+		goto Fail;
+	v += maxD + 1;
+	v[1] = 0;
+	for(d = 0; d <= maxD; ++d) {
+		for(k = -d; k <= d; k += 2) {
+			x = (k == -d || (k != d && v[k - 1] < v[k + 1])) ? v[k + 1] : v[k - 1] + 1;
+			y = x - k;
+			while(x < n && y < m && f_diffEq(pCtrl->a + aLo + x, pCtrl->b + bLo + y)) {
+				++x;
+				++y;
+				}
+			v[k] = x;
+			if(x >= n && y >= m)
+				goto Found;
+			}
+		if((d + 1) * (d + 1) > traceSize) {
+			if((pv = (long *) realloc((void *) trace, sizeof(long) * (traceSize = (d + 1) * (d + 1) * 2))) == NULL)
+				goto Fail;
+			trace = pv;
+			}
+		memcpy(trace + d * d, v - d, sizeof(long) * (2 * d + 1));
+		}
+
+	// Too many differences: replace the whole range.
+	(void) f_diffApply(pCtrl, aLo, aHi, bLo, bHi);
+	goto Retn;
+Found:
+	// Backward pass: follow the path from the end back to the beginning, applying each run of edits (hunk) between
+	// matching lines as it is completed.
+	x = n;
+	y = m;
+	for(; d > 0; --d) {
+		pv = trace + (d - 1) * (d - 1) + (d - 1);
+		k = x - y;
+		if(k == -d || (k != d && pv[k - 1] < pv[k + 1]))
+			midX = pv[prevK = k + 1];		// Line inserted.
+		else
+			midX = pv[prevK = k - 1] + 1;		// Line deleted.
+		if(x > midX && open) {
+			if(f_diffApply(pCtrl, aLo + hunk[0], aLo + hunk[1], bLo + hunk[2], bLo + hunk[3]) != Success)
+				goto Retn;
+			open = false;
+			}
+		if(!open) {
+			hunk[1] = midX;
+			hunk[3] = midX - k;
+			open = true;
+			}
+		hunk[0] = x = pv[prevK];
+		hunk[2] = y = x - prevK;
+		}
+	if(open)
+		(void) f_diffApply(pCtrl, aLo + hunk[0], aLo + hunk[1], bLo + hunk[2], bLo + hunk[3]);
+Retn:
+	free((void *) trace);
+	free((void *) (v - (maxD + 1)));
+	return sess.rtn.status;
+Fail:
+	if(v != NULL)
+		free((void *) (v - (maxD + 1)));
+	free((void *) trace);
+	return rsset(Panic, 0, text94, "f_diffRange");
+		// "%s(): Out of memory!"
+	}
+
+// Update given buffer from file pathname, which was read into buffer pNewBuf.  The changed lines are found by comparing the
+// buffer with the new text and are replaced with the edit primitives so that marks and window faces are adjusted.  If the
+// buffer is narrowed, the hidden fragments must match the beginning and end of the file.  Set *pChangeCt to the number of
+// changes applied and return status.
+static int f_reload(Buffer *pBuf, Buffer *pNewBuf, const char *pathname, uint *pChangeCt) {
+	long top = 0, bot = 0, aLo, aHi, bLo, bHi;
+	Line *pLine;
+	Face face;
+	BufCtrl oldEdit;
+	ushort oldFlags;
+	DiffCtrl ctrl = {NULL, NULL, 0, 0, NULL, 0, 0};
+
+	// Load line arrays (including hidden fragments for the file).
+	ctrl.aCt = pBuf->lineTotal;
+	ctrl.bCt = pNewBuf->lineTotal;
+	if((ctrl.a = f_diffLoad(pBuf->pFirstLine, ctrl.aCt)) == NULL ||
+	 (ctrl.b = f_diffLoad(pNewBuf->pFirstLine, ctrl.bCt)) == NULL) {
+		(void) rsset(Panic, 0, text94, "f_reload");
+			// "%s(): Out of memory!"
+		goto Retn;
+		}
+
+	// If buffer is narrowed, match its top and bottom fragments against the first and last lines of the file.
+	if(pBuf->flags & BFNarrowed) {
+		struct DiffLine diffLine;
+
+		if((pLine = pBuf->pNarTopLine) != NULL)
+			for(;;) {
+				diffLine.pLine = pLine;
+				diffLine.hash = f_hash(FIHashBasis, pLine->text, pLine->used);
+				if(top == ctrl.bCt || !f_diffEq(&diffLine, ctrl.b + top))
+					goto Outside;
+				++top;
+				if(pLine == pBuf->pNarTopLine->prev)
+					break;
+				pLine = pLine->next;
+				}
+		if((pLine = pBuf->pNarBotLine) != NULL) {
+			long i;
+
+			do {
+				++bot;
+				} while((pLine = pLine->next) != NULL);
+			if(top + bot >= ctrl.bCt)
+				goto Outside;
+			i = ctrl.bCt - bot;
+			for(pLine = pBuf->pNarBotLine; pLine != NULL; pLine = pLine->next) {
+				diffLine.pLine = pLine;
+				diffLine.hash = f_hash(FIHashBasis, pLine->text, pLine->used);
+				if(!f_diffEq(&diffLine, ctrl.b + i++))
+					goto Outside;
+				}
+			}
+		if(top + bot >= ctrl.bCt) {
+Outside:
+			(void) rsset(Failure, 0, text511, pathname);
+				// "File \"%s\" was changed outside of narrowed region"
+			goto Retn;
+			}
+		}
+
+	// Skip matching lines at the beginning and end.
+	aLo = 0;
+	bLo = top;
+	aHi = ctrl.aCt;
+	bHi = ctrl.bCt - bot;
+	while(aLo < aHi && bLo < bHi && f_diffEq(ctrl.a + aLo, ctrl.b + bLo)) {
+		++aLo;
+		++bLo;
+		}
+	while(aHi > aLo && bHi > bLo && f_diffEq(ctrl.a + aHi - 1, ctrl.b + bHi - 1)) {
+		--aHi;
+		--bHi;
+		}
+
+	// Make buffer the current edit buffer with a private face, lift any read-only restriction, and apply the changes.
+	if(aLo < aHi || bLo < bHi) {
+		oldEdit = sess.edit;
+		oldFlags = pBuf->flags;
+		sess.edit.pBuf = pBuf;
+		faceInit(sess.edit.pFace = &face, pBuf->pFirstLine, NULL);
+		sess.edit.pScrn = (EScreen *) (sess.edit.pWind = NULL);
+		pBuf->flags &= ~BFReadOnly;
+		(void) f_diffRange(&ctrl, aLo, aHi, bLo, bHi);
+		sess.edit = oldEdit;
+		pBuf->flags |= oldFlags & BFReadOnly;
+		}
+Retn:
+	*pChangeCt = ctrl.changeCt;
+	free((void *) ctrl.a);
+	free((void *) ctrl.b);
+	free((void *) ctrl.buf);
+	return sess.rtn.status;
+	}
+
+// Update current buffer from its file if the file was changed since it was last read or saved: compare the size and
+// modification time of the file with those noted when the buffer was last read or saved (or if n argument, skip this check),
+// then compare the hash of the file text.  If the file was changed, replace only the lines that differ, keeping marks, window
+// faces, and narrowing.  Set pRtnVal to true if buffer was updated, otherwise false.  Return status.
+int reloadBuf(Datum *pRtnVal, int n, Datum **args) {
+	struct stat s;
+	Buffer *pNewBuf;
+	char *pathname;
+	ulong hash;
+	uint changeCt;
+	bool yep;
+	Buffer *pBuf = sess.cur.pBuf;
+
+	dsetbool(false, pRtnVal);
+	if(pBuf->filename == NULL)
+		return rsset(Failure, 0, text493, text83, pBuf->bufname);
+			// "No filename set for %s '%s'", "buffer"
+	if(!(pBuf->flags & BFActive))
+		return sess.rtn.status;				// File not read yet.
+	if((pathname = f_absPath(pBuf, 0)) == NULL)
+		return rsset(Panic, 0, text94, "reloadBuf");
+			// "%s(): Out of memory!"
+
+	// Quick check: file size and modification time.
+	if(stat(pathname, &s) != 0) {
+		(void) rsset(Failure, 0, text141, strerror(errno), pathname);
+				// "I/O Error: %s, file \"%s\""
+		goto Free;
+		}
+	if(n == INT_MIN && s.st_size == pBuf->statSize && s.st_mtime == pBuf->statTime)
+		goto Free;
+
+	// Read file into a system buffer and compare its hash with that of the text last read or saved.
+	if(sysBuf(text509, &pNewBuf, 0) != Success)
+			// "Reload"
+		goto Free;
+	if(readIn(pNewBuf, pathname, RWExist) != Success || (pNewBuf->flags & BFReadOnly))
+		goto Delete;
+	hash = f_hashBuf(pNewBuf);
+	if(pBuf->statSize >= 0 && hash == pBuf->textHash) {
+		pBuf->statSize = s.st_size;			// File was touched but not changed.
+		pBuf->statTime = s.st_mtime;
+		goto Delete;
+		}
+
+	// File changed.  Get confirmation if buffer was changed as well, then update it.
+	if(pBuf->flags & BFChanged) {
+		if(terminpYN(text32, &yep) != Success)
+				// "Discard changes"
+			goto Delete;
+		(void) mlerase(MLForce);
+		if(!yep) {
+			(void) rsset(Cancelled, 0, NULL);
+			goto Delete;
+			}
+		}
+	if(f_reload(pBuf, pNewBuf, pathname, &changeCt) == Success) {
+
+		// Buffer now matches file.
+		if(pBuf->flags & BFNarrowed)
+			pBuf->statSize = -1;
+		else {
+			pBuf->statSize = s.st_size;
+			pBuf->statTime = s.st_mtime;
+			pBuf->textHash = hash;
+			}
+		pBuf->readSize = s.st_size;
+		pBuf->flags &= ~BFChanged;
+		supd_windFlags(pBuf, WFMode);
+		journalEnd(pBuf, true);
+		if(pBuf->pFollow != NULL)
+			f_followSync(pBuf);
+		dsetbool(true, pRtnVal);
+		(void) rsset(Success, RSHigh, text510, pathname, changeCt, changeCt != 1 ? "s" : "");
+			// "Reloaded file \"%s\" (%u change%s)"
+		}
+Delete:
+	(void) bdelete(pNewBuf, 0);			// Left for reuse if an error occurred.
+Free:
+	free((void *) pathname);
+	return sess.rtn.status;
+	}
+
 // Check if a buffer's filename matches given filename.  Return status, including NotFound if no match.
 static int fileCompare(Buffer *pBuf, const char *filename) {
 
@@ -1339,22 +3349,238 @@ static int bufStatusCheck(Buffer *pBuf) {
 	return sess.rtn.status;
 	}
 
-// Write a buffer to disk, given buffer, filename and mode ('w' = write, 'a' = append) and return status.  Before the file is
-// written, a user routine (write hook) can be run.  The number of lines written, and possibly other status information is
-// displayed.  If "ATerm" mode is enabled and the buffer does not have a terminating line delimiter, one is added before the
-// buffer is written.  If "Safe" or "Bak" mode is enabled, the buffer is written out to a temporary file, the old file is
-// unlinked or renamed to "<file>.bak" (if "<file>.bak" does not already exist), and the temporary is renamed to the original.
-static int writeOut(Buffer *pBuf, const char *filename, short mode, ushort flags) {
-	uint lineCt;			// Number of lines written.
-	int status;			// Return status.
-	ushort saveFlags = 0;		// Are we safe saving? (0x01 bit = 'safe' save, 0x02 bit = 'bak' save)
-	DFab fab;
-	struct stat s;			// File permision info.
-	Datum *pTempName;		// Temporary filename.
-	Datum *pBakName;		// Backup filename.
+// Mark given buffer as changed again after its durable save failed.
+static void f_syncUnsave(Buffer *pBuf) {
 
-	if(dopentrack(&fab) != 0)
-		goto LibFail;
+	pBuf->flags |= BFChanged;
+	supd_windFlags(pBuf, WFMode);
+	journalChange(pBuf);
+	}
+
+// Complete all pending durable saves.  The data of each temporary file is flushed to disk (writeback was started when the
+// file was closed, so the flushes overlap), the target file is linked or renamed to its backup name if applicable, and the
+// temporary file is renamed over the target, replacing it atomically.  Lastly, each distinct directory involved is synced
+// once so that the renames are durable.  If a file cannot be replaced, its buffer is marked as changed again and an error
+// is returned; otherwise, if the buffer was saved to its own file, the file's state is noted, the buffer's edit journal is
+// discarded (once the directory has been synced), and follow mode is resynchronized with the file.  Return status.
+static int f_syncAll(void) {
+	SyncSave *pSync, *pSync1;
+	SyncSave *pSyncEnd = syncSaves + syncSaveCt;
+	int fileHandle;
+	Buffer *pBuf;
+
+	for(pSync = syncSaves; pSync < pSyncEnd; ++pSync) {
+		if((fileHandle = openat(pSync->dirFD, pSync->tempName, O_RDONLY)) != -1) {
+			if(fdsync(fileHandle) != 0) {
+				int errNum = errno;
+
+				(void) close(fileHandle);
+				errno = errNum;
+				}
+			else if(close(fileHandle) == 0 && (pSync->bakName == NULL ||
+			 linkat(pSync->dirFD, pSync->filename, pSync->dirFD, pSync->bakName, 0) == 0 ||
+			 renameat(pSync->dirFD, pSync->filename, pSync->dirFD, pSync->bakName) == 0) &&
+			 renameat(pSync->dirFD, pSync->tempName, pSync->dirFD, pSync->filename) == 0)
+				continue;
+			}
+
+		// Replacement failed.  Report it and leave temporary file in place.
+		if(sess.rtn.status == Success) {
+			DFab msg;
+
+			if(dopentrack(&msg) != 0 || dputf(&msg, 0, text141, strerror(errno), pSync->filename) != 0 ||
+					// "I/O Error: %s, file \"%s\""
+			 dputc(' ', &msg, 0) != 0 || dputf(&msg, 0, text150, pSync->tempName) != 0 ||
+					// "(file saved as \"%s\") "
+			 dclose(&msg, FabStr) != 0)
+				return libfail();
+			(void) rsset(Failure, RSHigh | RSNoFormat, msg.pDatum->str);
+			}
+		f_syncUnsave(pSync->pBuf);
+		pSync->pBuf = NULL;
+		}
+
+	// Sync directories, skipping any already done.
+	for(pSync = syncSaves; pSync < pSyncEnd; ++pSync) {
+		pSync1 = syncSaves;
+		while(pSync1 < pSync && (pSync1->dirDev != pSync->dirDev || pSync1->dirIno != pSync->dirIno))
+			++pSync1;
+		if(pSync1 != pSync)
+			pSync->dirSynced = pSync1->dirSynced;
+		else if(!(pSync->dirSynced = (fsync(pSync->dirFD) == 0)))
+			(void) rsset(Failure, RSHigh, text141, strerror(errno), pSync->filename);
+					// "I/O Error: %s, file \"%s\""
+		}
+
+	// Update buffers saved to their own files and release pending saves.
+	for(pSync = syncSaves; pSync < pSyncEnd; ++pSync) {
+		if((pBuf = pSync->pBuf) != NULL && pSync->bufFile) {
+			if(pBuf->flags & BFNarrowed)
+				pBuf->statSize = -1;			// File contains visible portion only.
+			else
+				f_stamp(pBuf, pSync->dirFD, pSync->filename);
+			if(pSync->dirSynced)
+				journalEnd(pBuf, true);
+			if(pBuf->pFollow != NULL)
+				f_followSync(pBuf);
+			}
+		(void) close(pSync->dirFD);
+		free((void *) pSync->tempName);
+		}
+	syncSaveCt = 0;
+
+	return sess.rtn.status;
+	}
+
+// Prepare durable save of given buffer: give temporary file just written the permissions and ownership of the target file
+// (if it exists) and add a pending save for it.  bufFile is true if the buffer is being saved to its own file.  Complete the
+// save now unless saves are being deferred by saveBufs().  If an error occurs, the temporary file is deleted and the buffer is
+// marked as changed again.  Return status.
+static int f_syncSave(Buffer *pBuf, const char *tempName, const char *filename, const char *bakName, bool bufFile) {
+	SyncSave *pSync;
+	struct stat s;
+	const char *dir;
+	char *str;
+	const char *tempPath = tempName;
+	size_t dirLen = fbasename(filename, true) - filename;
+
+	// Copy permissions of original file, if any.
+	if(stat(filename, &s) == 0 && (chmod(tempName, s.st_mode) != 0 ||
+	 ((s.st_uid != geteuid() || s.st_gid != getegid()) && chown(tempName, s.st_uid, s.st_gid) != 0)))
+		goto IOFail;
+
+	// Get a SyncSave record.
+	if(syncSaveCt == syncSaveMax) {
+		int n = syncSaveMax == 0 ? 8 : syncSaveMax * 2;
+
+		if((pSync = (SyncSave *) realloc((void *) syncSaves, n * sizeof(SyncSave))) == NULL)
+			goto NoMem;
+		syncSaves = pSync;
+		syncSaveMax = n;
+		}
+	pSync = syncSaves + syncSaveCt;
+
+	// Open directory containing file and save names relative to it (in one heap block).
+	if(dirLen == 0)
+		dir = ".";
+	else {
+		if((str = (char *) malloc(dirLen + 1)) == NULL)
+			goto NoMem;
+		stplcpy(str, filename, dirLen + 1);
+		dir = str;
+		}
+	pSync->dirFD = open(dir, O_RDONLY);
+	if(dirLen > 0)
+		free((void *) str);
+	if(pSync->dirFD == -1)
+		goto IOFail;
+	if(fstat(pSync->dirFD, &s) != 0) {
+		int errNum = errno;
+
+		(void) close(pSync->dirFD);
+		errno = errNum;
+		goto IOFail;
+		}
+	pSync->dirDev = s.st_dev;
+	pSync->dirIno = s.st_ino;
+	tempName += dirLen;
+	filename += dirLen;
+	if(bakName != NULL)
+		bakName += dirLen;
+	if((str = (char *) malloc(strlen(tempName) + strlen(filename) + (bakName == NULL ? 0 : strlen(bakName)) + 3)) ==
+	 NULL) {
+		(void) close(pSync->dirFD);
+		goto NoMem;
+		}
+	pSync->filename = stpcpy(pSync->tempName = str, tempName) + 1;
+	str = stpcpy(pSync->filename, filename) + 1;
+	pSync->bakName = (bakName == NULL) ? NULL : strcpy(str, bakName);
+	pSync->pBuf = pBuf;
+	pSync->bufFile = bufFile;
+	++syncSaveCt;
+
+	return syncDefer ? sess.rtn.status : f_syncAll();
+IOFail:
+	(void) rsset(Failure, RSHigh, text141, strerror(errno), filename);
+		// "I/O Error: %s, file \"%s\""
+	goto Fail;
+NoMem:
+	(void) rsset(Panic, 0, text94, "f_syncSave");
+		// "%s(): Out of memory!"
+Fail:
+	(void) unlink(tempPath);
+	f_syncUnsave(pBuf);
+	return sess.rtn.status;
+	}
+
+// Get elapsed time in seconds since given start time.
+static double f_elapsed(const struct timespec *pStart) {
+	struct timespec t;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double) (t.tv_sec - pStart->tv_sec) + (double) (t.tv_nsec - pStart->tv_nsec) / 1e9;
+	}
+
+// Prepare given buffer for writing.  If buffer is narrowed and bottom portion exists, ignore ATerm mode and set *pAddNL to
+// true so that a newline is added to output file at EOB; otherwise, append a line delimiter to the buffer if ATerm mode set
+// and last line not empty.  Return status.
+static int f_wprep(Buffer *pBuf, bool *pAddNL) {
+	Line *pLine;
+
+	if(!(*pAddNL = (pBuf->flags & BFNarrowed) && pBuf->pNarBotLine != NULL) && pBuf->pFirstLine->prev->used > 0 &&
+	 modeSet(MdIdxATerm, pBuf)) {
+		if(lalloc(0, pBuf, &pLine) != Success)	// Empty line.
+			return sess.rtn.status;		// Fatal error.
+		llink(pLine, pBuf, NULL);		// Append empty line (newline) to end of buffer and...
+		bchange(pBuf, WFHard);			// set "change" flags.
+		}
+	return sess.rtn.status;
+	}
+
+// Write a buffer to an open file descriptor (disk file or pipe).  Return status.
+int writeDiskPipe(Buffer *pBuf, uint *pLineCount) {
+	uint lineCt;
+	bool addNL;
+	struct timespec t0;
+
+	if(mlputs(MLHome | MLWrap | MLFlush, text148) != Success || f_wprep(pBuf, &addNL) != Success)
+					// "Writing data..."
+		return sess.rtn.status;
+
+	// Write the buffer's lines to the open file, compressing them if applicable.
+	(void) clock_gettime(CLOCK_MONOTONIC, &t0);
+	f_sopen(&otpStream, fileInfo.fileHandle, fileInfo.flags & FIRetry);
+	if(((fileInfo.flags & FICompress) && f_zopen(&otpStream) != 0) ||
+	 f_writeLines(&otpStream, pBuf, fileInfo.realOtpDelim.u.pDelim, fileInfo.realOtpDelim.len, addNL, &lineCt) != 0) {
+
+		// Write error: clean up and get out.
+		(void) rsset(Failure, RSHigh, text141, strerror(otpStream.errNum), fileInfo.filename);
+				// "I/O Error: %s, file \"%s\""
+		(void) f_close(true);
+		return sess.rtn.status;
+		}
+
+	// Write was successful: close output file, note byte count and elapsed time for ioStat(), and return.
+	otpCount = otpStream.count;
+	if(pLineCount != NULL)
+		*pLineCount = lineCt;
+	if(f_close(true) == Success)
+		otpTime = f_elapsed(&t0);
+	return sess.rtn.status;
+	}
+
+// Begin save of buffer to file in given SaveJob object, given mode ('w' = write, 'a' = append): run the user-assigned write
+// hook, determine whether a safe save will be done, and open the output file (target file or a temporary one).  The file is
+// written gzip-compressed if the target filename ends with GzipExt (when appending, a new gzip member is added).  Return
+// status.
+static int f_saveOpen(SaveJob *pJob, short mode) {
+	Buffer *pBuf = pJob->pBuf;
+	const char *filename = pJob->filename;
+	size_t len = strlen(filename);
+
+	pJob->saveFlags = 0;
+	pJob->errNum = 0;
+	pJob->compress = len > strlen(GzipExt) && strcmp(filename + len - strlen(GzipExt), GzipExt) == 0;
 
 	// Run user-assigned write hook.
 	if(!(pBuf->flags & (BFHidden | BFCommand | BFFunc)) &&
@@ -1366,66 +3592,85 @@ static int writeOut(Buffer *pBuf, const char *filename, short mode, ushort flags
 		if(modeSet(MdIdxBak, pBuf)) {
 
 			// 'Bak' mode enabled.  Create backup version of filename.
-			if(dnewtrack(&pBakName) != 0 || dsalloc(pBakName, strlen(filename) + strlen(BackupExt) + 1) != 0)
+			if(dnewtrack(&pJob->pBakName) != 0 || dsalloc(pJob->pBakName, strlen(filename) + strlen(BackupExt) + 1) != 0)
 				goto LibFail;
-			sprintf(pBakName->str, "%s%s", filename, BackupExt);
+			sprintf(pJob->pBakName->str, "%s%s", filename, BackupExt);
 
 			// Enable '.bak' save if backup file does not already exist.
-			if(fileExists(pBakName->str) == 0)
-				saveFlags = 0x02;
+			if(fileExists(pJob->pBakName->str) == 0)
+				pJob->saveFlags = SVBak;
 			}
 		if(modeSet(MdIdxSafe, pBuf))
-			saveFlags |= 0x01;
+			pJob->saveFlags |= SVSafe;
 		}
+	if(mode == 'w' && modeSet(MdIdxSync, pBuf))
+		pJob->saveFlags |= SVSync;
 
 	// Open output file.
-	if(saveFlags) {
+	if(pJob->saveFlags) {
 		char *suffix;
-		size_t len;
 
 		// Duplicate original file pathname and keep first letter of filename.
 		len = fbasename(filename, true) - filename + 1;
-		if(dnewtrack(&pTempName) != 0 || dsalloc(pTempName, len + 6) != 0)
+		if(dnewtrack(&pJob->pTempName) != 0 || dsalloc(pJob->pTempName, len + 6) != 0)
 			goto LibFail;
-		stplcpy(pTempName->str, filename, len + 1);
-		suffix = pTempName->str + len;
+		stplcpy(pJob->pTempName->str, filename, len + 1);
+		suffix = pJob->pTempName->str + len;
 
 		// Create a unique name, using random numbers.
 		do {
 			longToAsc(urand(0x10000), suffix);
-			} while(fileExists(pTempName->str));
+			} while(fileExists(pJob->pTempName->str));
 
 		// Open the temporary file.
-		status = f_wopen(pBuf, pTempName->str, mode);
+		if(f_wopen(pBuf, pJob->pTempName->str, mode) != Success)
+			return sess.rtn.status;
+		if(pJob->saveFlags & SVSync)
+			fileInfo.flags |= FIDurable;
 		}
-	else
-		status = f_wopen(pBuf, filename, mode);
-
-	// If the open failed or write fails, abort mission.
-	if(status != Success || (status = writeDiskPipe(pBuf, &lineCt)) != Success) {
-		if(saveFlags)
-			(void) unlink(pTempName->str);
+	else if(f_wopen(pBuf, filename, mode) != Success)
 		return sess.rtn.status;
-		}
+	if(pJob->compress)
+		fileInfo.flags |= FICompress;
+	return sess.rtn.status;
+LibFail:
+	return libfail();
+	}
+
+// Complete save of buffer in given SaveJob object after file was written successfully, given mode and writeOut() flags: clear
+// buffer's "changed" flag, replace target file with temporary file if safe save, and report results if RWStats flag set.
+// Return status.
+static int f_saveDone(SaveJob *pJob, short mode, ushort flags) {
+	int status = Success;		// Return status.
+	Buffer *pBuf = pJob->pBuf;
+	const char *filename = pJob->filename;
+	DFab fab;
+	struct stat s;			// File permision info.
+
+	if(dopentrack(&fab) != 0)
+		goto LibFail;
 
-	// Write was successful: clear "changed" flag and update window flags.
+	// Clear "changed" flag and update window flags.
 	pBuf->flags &= ~BFChanged;
 	supd_windFlags(pBuf, WFMode);
 
-	// Do file manipulations if safe save.
-	if(saveFlags) {
+	// Do file manipulations if sync or safe save.
+	if(pJob->saveFlags & SVSync)
+		status = f_syncSave(pBuf, pJob->pTempName->str, filename,
+		 (pJob->saveFlags & SVBak) ? pJob->pBakName->str : NULL, pJob->bufFile && mode == 'w');
+	else if(pJob->saveFlags) {
 		// Get the permisions of the original file.
 		if((status = stat(filename, &s)) != 0)
 			status = errno;
 
 		// Rename or erase original file and rename temp to original.
-		if(saveFlags & 0x02) {
-			if(rename(filename, pBakName->str) != 0)
+		if(pJob->saveFlags & SVBak) {
+			if(rename(filename, pJob->pBakName->str) != 0)
 				status = -1;
 			}
 		else if(unlink(filename) != 0)
 			status = -1;
-		if(status == 0 && rename(pTempName->str, filename) == 0) {
+		if(status == 0 && rename(pJob->pTempName->str, filename) == 0) {
 			if(chmod(filename, s.st_mode) != 0 || chown(filename, s.st_uid, s.st_gid) != 0)
 				status = errno;
 			}
@@ -1433,23 +3678,63 @@ static int writeOut(Buffer *pBuf, const char *filename, short mode, ushort flags
 		// Report any errors.
 		if(status != 0) {
 			if(dputf(&fab, 0, text141, strerror(errno), filename) != 0 || (status == -1 &&
-			 (dputc(' ', &fab, 0) != 0 || dputf(&fab, 0, text150, pTempName->str) != 0)))
+			 (dputc(' ', &fab, 0) != 0 || dputf(&fab, 0, text150, pJob->pTempName->str) != 0)))
 					// "I/O Error: %s, file \"%s\"", "(file saved as \"%s\") "
 				goto LibFail;
 			status = Failure;	// Failed.
 			}
 		}
 
+	// If buffer was saved to its own file (and the file is not still to be replaced by f_syncAll(), which does so itself), note
+	// the file's state, discard the buffer's edit journal, and resynchronize follow mode with file just written.
+	if(pJob->bufFile && status == Success && mode == 'w' && !(pJob->saveFlags & SVSync)) {
+		if(pBuf->flags & BFNarrowed)
+			pBuf->statSize = -1;				// File contains visible portion only.
+		else
+			f_stamp(pBuf, AT_FDCWD, pJob->filename);
+		journalEnd(pBuf, true);
+		if(pBuf->pFollow != NULL)
+			f_followSync(pBuf);
+		}
+
 	// Report lines written and return status.
 	return (flags & RWStats) ?
-	 ioStat(&fab, lineCt > 0 && (!(pBuf->flags & BFNarrowed) || pBuf->pNarBotLine == NULL) &&
-	  pBuf->pFirstLine->prev->used > 0 ? (IOS_OtpFile | IOS_NoDelim) : IOS_OtpFile,
-	  status == Success && (saveFlags & 0x02) ? pBakName : NULL, status, filename, text149, lineCt) : sess.rtn.status;
-									// "Wrote"
+	 ioStat(&fab, pJob->lineCt > 0 && (!(pBuf->flags & BFNarrowed) || pBuf->pNarBotLine == NULL) &&
+	  pBuf->pFirstLine->prev->used > 0 ? (IOS_OtpFile | IOS_NoDelim | IOS_Rate) : IOS_OtpFile | IOS_Rate,
+	  status == Success && (pJob->saveFlags & SVBak) ? pJob->pBakName : NULL, status, filename, text149, pJob->lineCt) :
+										// "Wrote"
+	 sess.rtn.status;
 LibFail:
 	return libfail();
 	}
 
+// Write a buffer to disk, given buffer, filename and mode ('w' = write, 'a' = append) and return status.  Before the file is
+// written, a user routine (write hook) can be run.  The number of lines written, and possibly other status information is
+// displayed.  If "ATerm" mode is enabled and the buffer does not have a terminating line delimiter, one is added before the
+// buffer is written.  If "Safe" or "Bak" mode is enabled, the buffer is written out to a temporary file, the old file is
+// unlinked or renamed to "<file>.bak" (if "<file>.bak" does not already exist), and the temporary is renamed to the original.
+// If "Sync" mode is enabled, a temporary file is always used, and it is flushed to disk and renamed over the original (which
+// is linked to the backup file if applicable) by f_syncSave(), so that the file is replaced atomically and durably.
+static int writeOut(Buffer *pBuf, const char *filename, short mode, ushort flags) {
+	SaveJob job;
+
+	job.pBuf = pBuf;
+	job.filename = filename;
+	job.bufFile = (pBuf->filename != NULL && strcmp(filename, pBuf->filename) == 0);
+
+	// Open the output file and write the buffer.  If the open failed or write fails, abort mission.
+	if(f_saveOpen(&job, mode) != Success)
+		return sess.rtn.status;
+	if(writeDiskPipe(pBuf, &job.lineCt) != Success) {
+		if(job.saveFlags)
+			(void) unlink(job.pTempName->str);
+		return sess.rtn.status;
+		}
+
+	// Write was successful.
+	return f_saveDone(&job, mode, flags);
+	}
+
 // Do appendFile or writeFile command.  Ask for a filename, and write or append the contents of the current buffer to that file.
 // Update the remembered filename if writeFile and default n or n > 0.  Return status.
 int appendWriteFile(Datum *pRtnVal, int n, const char *prompt, short mode) {
@@ -1485,9 +3770,13 @@ int appendWriteFile(Datum *pRtnVal, int n, const char *prompt, short mode) {
 	return sess.rtn.status;
 	}
 
-// Save given buffer to disk if possible.  *pCurDir contains current directory and is updated if directory is changed.  If
-// BS_QuickExit flag is set, buffer is flagged (with BFQSave) for "quickExit" command if saved.
-static int saveBuf(Buffer *pBuf, ushort flags, const char **pCurDir, const char *workDir, uint *pSavedCount, uint *pNarCount) {
+// Save given buffer to disk if possible.  workDir is the directory of the screen the buffer is being displayed on, or NULL if
+// it is in the background.  If the buffer's directory is not the current one, it is written via an absolute pathname.  If
+// saving all buffers and a free SaveJob slot exists in given control object, only the output file is opened and a pending
+// save is added for saveBufs() to complete; otherwise, the buffer is written immediately.  If BS_QuickExit flag is set,
+// buffer is flagged (with BFQSave) for "quickExit" command if saved.
+static int saveBuf(Buffer *pBuf, ushort flags, const char *workDir, SaveCtrl *pCtrl) {
+	const char *filename = pBuf->filename;
 
 	pBuf->flags &= ~BFQSave;					// Clear "saved" flag.
 	if(!(pBuf->flags & BFChanged) ||				// If not changed...
@@ -1497,13 +3786,13 @@ static int saveBuf(Buffer *pBuf, ushort flags, const char **pCurDir, const char
 		return rsset(Failure, 0, text145, pBuf->bufname);
 			// "No filename associated with buffer '%s'"
 	if((pBuf->flags & BFNarrowed) && (flags & BS_All)) {		// If narrowed and saving all...
-		++*pNarCount;						// count it and...
+		++pCtrl->narCount;					// count it and...
 		return Cancelled;					// skip it.
 		}
 	if(bufStatusCheck(pBuf) != Success)				// Complain about narrowed buffers.
 		return sess.rtn.status;
 
-	// Change working directory if needed.
+	// Determine directory if needed.
 	if((flags & BS_MultiDir) && *pBuf->filename != '/') {		// If multiple directories and have relative pathname...
 		if(workDir == NULL) {					// and buffer is in the background...
 			if(pBuf->saveDir == NULL)			// home directory set?
@@ -1531,52 +3820,175 @@ static int saveBuf(Buffer *pBuf, ushort flags, const char **pCurDir, const char
 			pBuf->saveDir = workDir;			// Yes, use screen's directory.
 			}
 
-		// It's a go... change directory if different.
-		if(*pCurDir != workDir && chgdir(*pCurDir = workDir) != Success)
-			return sess.rtn.status;
+		// It's a go... build absolute pathname if directory is not the current one.
+		if(workDir != sess.cur.pScrn->workDir) {
+			Datum *pPathname;
+
+			if(dnewtrack(&pPathname) != 0 ||
+			 dsalloc(pPathname, strlen(workDir) + strlen(pBuf->filename) + 2) != 0)
+				return libfail();
+			sprintf(pPathname->str, "%s/%s", workDir, pBuf->filename);
+			filename = pPathname->str;
+			}
 		}
 
 	// Save the buffer.
 	if(mlprintf(MLHome | MLWrap | MLFlush, text103, pBuf->filename) != Success)
 			// "Saving %s..."
 		return sess.rtn.status;
-	if((flags & (BS_All | BS_QuickExit)) == BS_All)
-		centiPause(40);
-	if(writeOut(pBuf, pBuf->filename, 'w', RWStats) != Success)
+	if(pCtrl->jobs != NULL && pCtrl->jobCt < pCtrl->jobMax) {
+		SaveJob *pJob = pCtrl->jobs + pCtrl->jobCt;
+
+		// Saving all: open output file and add pending save.
+		pJob->pBuf = pBuf;
+		pJob->filename = filename;
+		pJob->bufFile = true;
+		if(f_saveOpen(pJob, 'w') != Success)
+			return sess.rtn.status;
+		if(f_wprep(pBuf, &pJob->addNL) != Success) {
+			(void) f_close(true);
+			if(pJob->saveFlags)
+				(void) unlink(pJob->pTempName->str);
+			return sess.rtn.status;
+			}
+
+		// Detach output file from fileInfo (it will be written and closed by a worker thread) and clear "changed" flag so
+		// that the buffer is not saved again if it is displayed in another window.
+		pJob->fileHandle = fileInfo.fileHandle;
+		pJob->otpDelim = fileInfo.realOtpDelim;
+		fileInfo.fileHandle = -1;
+		fileInfo.filename = NULL;
+		fileInfo.flags = 0;
+		pBuf->flags &= ~BFChanged;
+		++pCtrl->jobCt;
+		return sess.rtn.status;
+		}
+	if(writeOut(pBuf, filename, 'w', RWStats) != Success)
 		return sess.rtn.status;
 	sess.autoSaveCount = sess.autoSaveTrig;			// Reset $autoSave...
-	++*pSavedCount;						// increment "save" count...
+	++pCtrl->savedCount;					// increment "save" count...
 	if(flags & BS_QuickExit)
 		pBuf->flags |= BFQSave;				// and flag as saved for main() to display on quick exit.
 	return sess.rtn.status;
 	}
 
+// Write buffers of pending saves in given control object to their open files and close them until none remain (thread
+// routine).  Each save is claimed under saveMutex; no other global state is referenced.
+static void *f_savejob(void *arg) {
+	SaveCtrl *pCtrl = (SaveCtrl *) arg;
+	SaveJob *pJob;
+	OtpStream stream;
+	struct timespec t0;
+
+	for(;;) {
+		(void) pthread_mutex_lock(&saveMutex);
+		pJob = (pCtrl->nextJob < pCtrl->jobCt) ? pCtrl->jobs + pCtrl->nextJob++ : NULL;
+		(void) pthread_mutex_unlock(&saveMutex);
+		if(pJob == NULL)
+			break;
+
+		(void) clock_gettime(CLOCK_MONOTONIC, &t0);
+		f_sopen(&stream, pJob->fileHandle, false);
+		if((pJob->compress && f_zopen(&stream) != 0) || f_writeLines(&stream, pJob->pBuf, pJob->otpDelim.u.pDelim,
+		 pJob->otpDelim.len, pJob->addNL, &pJob->lineCt) != 0)
+			pJob->errNum = stream.errNum;
+#ifdef SYNC_FILE_RANGE_WRITE
+		else if(pJob->saveFlags & SVSync)
+			(void) sync_file_range(pJob->fileHandle, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+		if(close(pJob->fileHandle) != 0 && pJob->errNum == 0)
+			pJob->errNum = errno;
+		pJob->count = stream.count;
+		pJob->time = f_elapsed(&t0);
+		}
+	return NULL;
+	}
+
+// Write buffers of pending saves in given control object in parallel, using up to FIParSaveMax threads (including this one),
+// then complete the saves and report any errors in the order the saves were added.  Return status.
+static int f_parsave(SaveCtrl *pCtrl, ushort flags) {
+	int threadCount, i;
+	SaveJob *pJob, *pJobEnd;
+
+	threadCount = (pCtrl->jobCt > FIParSaveMax) ? FIParSaveMax : pCtrl->jobCt;
+	pthread_t threads[threadCount];
+	bool started[threadCount];
+
+	// Start worker threads, process saves in this thread as well, then wait for the others.  If a thread cannot be created,
+	// the remaining threads do its share.
+	pCtrl->nextJob = 0;
+	for(i = 1; i < threadCount; ++i)
+		started[i] = (pthread_create(threads + i, NULL, f_savejob, (void *) pCtrl) == 0);
+	(void) f_savejob((void *) pCtrl);
+	for(i = 1; i < threadCount; ++i)
+		if(started[i])
+			(void) pthread_join(threads[i], NULL);
+
+	// Complete saves in order.
+	pJobEnd = pCtrl->jobs + pCtrl->jobCt;
+	for(pJob = pCtrl->jobs; pJob < pJobEnd; ++pJob) {
+		if(pJob->errNum != 0) {
+
+			// Write or close error: remove temporary file (if any) and mark buffer as changed again.
+			(void) rsset(Failure, RSHigh, text141, strerror(pJob->errNum), pJob->filename);
+					// "I/O Error: %s, file \"%s\""
+			if(pJob->saveFlags)
+				(void) unlink(pJob->pTempName->str);
+			pJob->pBuf->flags |= BFChanged;
+			supd_windFlags(pJob->pBuf, WFMode);
+			}
+		else {
+			// Write was successful.  Restore state of write for ioStat() and finish the save.
+			fileInfo.realOtpDelim = pJob->otpDelim;
+			otpCount = pJob->count;
+			otpTime = pJob->time;
+			if(f_saveDone(pJob, 'w', RWStats) == Success) {
+				sess.autoSaveCount = sess.autoSaveTrig;		// Reset $autoSave...
+				++pCtrl->savedCount;				// increment "save" count...
+				if(flags & BS_QuickExit)
+					pJob->pBuf->flags |= BFQSave;		// and flag as saved for quick exit.
+				}
+			}
+		}
+	pCtrl->jobCt = 0;
+
+	return sess.rtn.status;
+	}
+
 // Save the contents of the current buffer (or all buffers if n argument) to its associated file.  Do nothing if nothing has
-// changed.  Error if there is no filename set for a buffer.
+// changed.  Error if there is no filename set for a buffer.  If saving all, the buffers are written in parallel by worker
+// threads after the write hooks have been run and the output files opened, and completion of durable ("Sync" mode) saves is
+// deferred until all buffers have been written, so that their disk flushes overlap and each directory is synced only once.
 int saveBufs(int n, ushort flags) {
 	Datum **ppBufItem, **ppBufItemEnd;
 	Buffer *pBuf;
 	int status;
-	const char *workDir = sess.cur.pScrn->workDir;
-	uint savedCount = 0;			// Count of saved buffers.
-	uint narCount = 0;			// Count of narrowed buffers that are skipped.
+	SaveCtrl ctrl = {NULL, 0, 0, 0, 0, 0};
 
 	if(n != INT_MIN)
 		flags |= BS_All;
 	if(workDirStatus(NULL, NULL))
 		flags |= BS_MultiDir;
 
-	// Search for changed buffers one screen at a time if updating all to simplify tracking and minimize frequency of
-	// chdir() calls when multiple screen directories exist.
+	// Allocate pending saves if saving all.  If any more buffers than this need saving (which can only happen if a write
+	// hook creates buffers), they are written immediately.
+	if(flags & BS_All) {
+		if((ctrl.jobs = (SaveJob *) malloc(bufTable.used * sizeof(SaveJob))) == NULL)
+			return rsset(Panic, 0, text94, "saveBufs");
+				// "%s(): Out of memory!"
+		ctrl.jobMax = bufTable.used;
+		syncDefer = true;
+		}
+
+	// Search for changed buffers one screen at a time if updating all to simplify tracking of each screen's directory.
 	if(flags & BS_All) {
 		EWindow *pWind;
 		EScreen *pScrn = sess.scrnHead;
 		do {						// In all screens...
 			pWind = pScrn->windHead;
 			do {					// In all windows...
-				if((status = saveBuf(pWind->pBuf, flags, &workDir, pScrn->workDir, &savedCount,
-				 &narCount)) <= UserAbort)
-					return sess.rtn.status;
+				if((status = saveBuf(pWind->pBuf, flags, pScrn->workDir, &ctrl)) <= UserAbort)
+					goto Write;
 				} while((pWind = pWind->next) != NULL);
 			} while((pScrn = pScrn->next) != NULL);
 		}
@@ -1588,73 +4000,37 @@ int saveBufs(int n, ushort flags) {
 		// Skip any buffer being displayed if screen traversal was done so that any multi-homed buffers that were
 		// skipped (and counted) will be skipped here also.
 		if(!(flags & BS_All) || pBuf->windCount == 0) {
-			if((status = saveBuf(pBuf, flags, &workDir, pBuf == sess.cur.pBuf ? sess.cur.pScrn->workDir : NULL,
-			 &savedCount, &narCount)) <= UserAbort)
-				return sess.rtn.status;
+			if((status = saveBuf(pBuf, flags, pBuf == sess.cur.pBuf ? sess.cur.pScrn->workDir : NULL,
+			 &ctrl)) <= UserAbort)
+				goto Write;
 			}
 		if(!(flags & BS_All) || ++ppBufItem == ppBufItemEnd)
 			break;
 		pBuf = bufPtr(*ppBufItem);
 		}
+Write:
+	// Write pending saves (including any added before an error or user abort occurred).
+	if(ctrl.jobCt > 0)
+		(void) f_parsave(&ctrl, flags);
+	free((void *) ctrl.jobs);
 
-	// Return to original working directory if needed and set return message.
-	if(workDir != sess.cur.pScrn->workDir)
-		(void) chgdir(sess.cur.pScrn->workDir);
+	// Set return message.
 	if((flags & (BS_All | BS_QuickExit)) == BS_All && sess.rtn.status == Success) {
 		char workBuf[WorkBufSize];
 
-		sprintf(workBuf, text167, savedCount, savedCount != 1 ? "s" : "");
+		sprintf(workBuf, text167, ctrl.savedCount, ctrl.savedCount != 1 ? "s" : "");
 				// "%u buffer%s saved"
-		if(narCount > 0)
-			sprintf(strchr(workBuf, '\0'), text458, narCount, narCount != 1 ? "s" : "");
+		if(ctrl.narCount > 0)
+			sprintf(strchr(workBuf, '\0'), text458, ctrl.narCount, ctrl.narCount != 1 ? "s" : "");
 					// ", %u narrowed buffer%s skipped"
 		(void) rsset(Success, RSForce | RSNoFormat, workBuf);
 		}
-	return sess.rtn.status;
-	}
-
-// Write a buffer to an open file descriptor (disk file or pipe).  Return status.
-int writeDiskPipe(Buffer *pBuf, uint *pLineCount) {
-	Line *pLine, *pLineEnd;
-	uint lineCt;
-	bool addNL = (pBuf->flags & BFNarrowed) && pBuf->pNarBotLine != NULL;
-
-	if(mlputs(MLHome | MLWrap | MLFlush, text148) != Success)
-					// "Writing data..."
-		return sess.rtn.status;
-
-	// Check if buffer is narrowed and/or ATerm mode is set.  If buffer is narrowed and bottom portion exists, ignore ATerm
-	// mode and add a newline to output file at EOB; otherwise, append a line delimiter to the buffer if ATerm mode set and
-	// last line not empty.
-	pLineEnd = (pLine = pBuf->pFirstLine)->prev;
-	if(!addNL && pLineEnd->used > 0 && modeSet(MdIdxATerm, pBuf)) {
-		Line *pLine0;
 
-		if(lalloc(0, &pLine0) != Success)	// Empty line.
-			return sess.rtn.status;		// Fatal error.
-		llink(pLine0, pBuf, NULL);		// Append empty line (newline) to end of buffer...
-		bchange(pBuf, WFHard);			// set "change" flags...
-		pLineEnd = pLine->prev;			// and update "last line" pointer.
-		}
-
-	// Write the current buffer's lines to the open file.
-	lineCt = 0;
-	while(pLine != pLineEnd || addNL || pLine->used > 0) {
-		if(f_putline(pLine, pLine != pLineEnd || addNL) != Success) {
-
-			// Write or close error: clean up and get out.
-			(void) f_close(true);
-			return sess.rtn.status;
-			}
-		++lineCt;
-		if((pLine = pLine->next) == NULL)
-			break;
-		}
-
-	// Write was successful: close output file and return.
-	if(pLineCount != NULL)
-		*pLineCount = lineCt;
-	return f_close(true);
+	// Complete any deferred durable saves.
+	syncDefer = false;
+	if(syncSaveCt > 0)
+		(void) f_syncAll();
+	return sess.rtn.status;
 	}
 
 // Set the filename associated with a buffer and call the filename hook if appropriate (or return an error if the buffer is
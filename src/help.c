@@ -488,48 +488,35 @@ int showPoint(Datum *pRtnVal, int n, Datum **args) {
 	ulong numChars = 0;		// # of chars in file.
 	ulong numLines = 0;		// # of lines in file.
 	ulong preChars = 0;		// # chars preceding point.
-	ulong preLineCount = 0;		// # lines preceding point.
 	short curChar = '\0';		// Character at point.
 	double ratio = 0.0;
 	int col = 0;
 	int endCol = 0;			// Column pos/end of current line.
 	Point workPoint;
 	char *info;
+	Buffer *pBuf = sess.cur.pBuf;
 	Point *pPoint = &sess.cur.pFace->point;
 	char *str, workBuf1[32], workBuf2[32];
 
 	str = strcpy(workBuf2, "0.0");
 	if(!bempty(NULL)) {
 		if(n == INT_MIN) {
-
-			// Start at the beginning of the buffer.
-			pLine = sess.cur.pBuf->pFirstLine;
-			curChar = '\0';
-
-			// Count characters and lines.
-			numChars = numLines = 0;
-			while(pLine->next != NULL || pLine->used > 0) {
-
-				// If we are on the current line, save "pre-point" stats.
-				if(pLine == pPoint->pLine) {
-					curLine = (preLineCount = numLines) + 1;
-					preChars = numChars + pPoint->offset;
-					if(pLine->next != NULL || pPoint->offset < pLine->used)
-						curChar = (pPoint->offset < pLine->used) ? pLine->text[pPoint->offset] : '\n';
-					}
-
-				// On to the next line.
-				++numLines;
-				numChars += pLine->used + (pLine->next == NULL ? 0 : 1);
-				if((pLine = pLine->next) == NULL)
-					break;
-				}
-
-			// If point is at end of buffer, save "pre-point" stats.
-			if(bufEnd(pPoint)) {
-				curLine = (preLineCount = numLines) + (pPoint->pLine->used == 0 ? 1 : 0);
-				preChars = numChars;
-				}
+			int lineCount;
+			long byteCount;
+
+			// Get buffer totals and point line number.
+			numChars = bufLength(pBuf, &lineCount);
+			numLines = lineCount;
+			curLine = getLineNum(pBuf, pPoint->pLine);
+
+			// Count bytes in lines preceding point, walking from whichever end of the buffer is closer.
+			if((long) curLine <= pBuf->lineTotal / 2)
+				for(byteCount = 0, pLine = pBuf->pFirstLine; pLine != pPoint->pLine; pLine = pLine->next)
+					byteCount += pLine->used;
+			else
+				for(byteCount = pBuf->byteTotal, pLine = pPoint->pLine; pLine != NULL; pLine = pLine->next)
+					byteCount -= pLine->used;
+			preChars = byteCount + (curLine - 1) + pPoint->offset;
 
 			ratio = 0.0;				// Ratio before point.
 			if(numChars > 0)
@@ -544,7 +531,7 @@ int showPoint(Datum *pRtnVal, int n, Datum **args) {
 					str = "99.9";
 				}
 			}
-		else if(!bempty(NULL) && (pPoint->pLine->next != NULL || pPoint->offset < pPoint->pLine->used))
+		if(pPoint->pLine->next != NULL || pPoint->offset < pPoint->pLine->used)
 			curChar = (pPoint->offset == pPoint->pLine->used) ? '\n' : pPoint->pLine->text[pPoint->offset];
 
 		// Get real column and end-of-line column.
@@ -813,7 +800,7 @@ static char *inflate1(char *dest, const char *src) {
 
 // Copy src to dest in upper case, inserting a space between each two characters.  If plural is true, append "s" or "es".
 // Return dest.
-char *inflate(char *dest, const char *src, bool plural) {
+char *inflateStr(char *dest, const char *src, bool plural) {
 
 	dest = inflate1(dest, src);
 	if(plural)
@@ -838,7 +825,7 @@ static int rptHdr(DFab *rpt, const char *title, bool plural, const char *colHead
 	char workBuf[term.cols + 1];
 
 	// Expand title, get page width, and begin color if applicable.
-	inflate(workBuf, title, plural);
+	inflateStr(workBuf, title, plural);
 	if(pWidth == NULL) {
 		if(colHead == NULL)
 			width = term.cols;
@@ -1585,7 +1572,7 @@ int showBuffers(Datum *pRtnVal, int n, Datum **args) {
 		{SB_ReadOnly, text459},			// "Read only"
 		{SB_Changed, text439},			// "Changed"
 		{'\0', NULL}};
-	static bool selCommand, selFunction, selHomed, selVisible, inclHidden, inclHomeDir;
+	static bool selCommand, selFunction, selHomed, selVisible, inclHidden, inclHomeDir, inclMemory;
 	static Option options[] = {
 		{"^Visible", "^Viz", 0, .u.ptr = (void *) &selVisible},
 		{"Ho^med", "H^md", 0, .u.ptr = (void *) &selHomed},
@@ -1593,6 +1580,7 @@ int showBuffers(Datum *pRtnVal, int n, Datum **args) {
 		{"^Function", "^Func", 0, .u.ptr = (void *) &selFunction},
 		{"^Hidden", "^Hid", 0, .u.ptr = (void *) &inclHidden},
 		{"Home^Dir", "Hm^Dir", 0, .u.ptr = (void *) &inclHomeDir},
+		{"^Memory", "^Mem", 0, .u.ptr = (void *) &inclMemory},
 		{NULL, NULL, 0, 0}};
 	static OptHdr optHdr = {
 		0, text410, false, options};
@@ -1660,7 +1648,7 @@ int showBuffers(Datum *pRtnVal, int n, Datum **args) {
 		// Write separator line if displaying home directory and not first buffer.
 		if(firstBuf)
 			firstBuf = false;
-		else if(inclHomeDir && sepLine(pageWidth, &rpt) != 0)
+		else if((inclHomeDir || inclMemory) && sepLine(pageWidth, &rpt) != 0)
 			goto LibFail;
 
 		if(dputc('\n', &rpt, 0) != 0)
@@ -1696,6 +1684,12 @@ int showBuffers(Datum *pRtnVal, int n, Datum **args) {
 		if(inclHomeDir && pBuf->saveDir != NULL &&
 		 dputf(&rpt, 0, "\n%*s%sCWD: %s", colWidths[0].minWidth, "", space, pBuf->saveDir) != 0)
 			goto LibFail;
+
+		// Output the line storage statistics if requested.
+		if(inclMemory && dputf(&rpt, 0, text499, colWidths[0].minWidth, "", space, pBuf->linePool.lineCount,
+		 pBuf->linePool.freeCount, pBuf->linePool.chunkCount, pBuf->linePool.chunkBytes / 1024, pBuf->linePool.bigCount) != 0)
+				// "\n%*s%sLines: %lu pooled, %lu free in %lu chunks (%luK), %lu oversize"
+			goto LibFail;
 		}
 
 	// Write footnote.
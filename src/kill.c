@@ -505,14 +505,22 @@ int iorStr(const char *src, int n, ushort style, Ring *pRing) {
 		}
 	else
 		reps = n;
+	str = (src == NULL) ? pEntry->data.str : src;
+	size = strlen(str);
 	while(reps-- > 0) {
-		size = 0;
-		str = (src == NULL) ? pEntry->data.str : src;
-		do {
-			if(iorChar(*str++, style) != Success)
+
+		// Insert text in one step if possible; otherwise, overwrite or replace one character at a time.
+		if(style & Txt_Insert) {
+			if(einsertBlk(str, size, style & Txt_LiteralNL) != Success)
 				return sess.rtn.status;
-			++size;
-			} while(*str != '\0');
+			}
+		else {
+			const char *str1 = str;
+			do {
+				if(iorChar(*str1++, style) != Success)
+					return sess.rtn.status;
+				} while(*str1 != '\0');
+			}
 		}
 
 	// If requested, set point back to the beginning of the new text and move region mark.
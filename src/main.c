@@ -642,6 +642,7 @@ static int editInit1(void) {
 			{"Fence1", MLit_Fence1, MdGlobal | MdHidden | MdEnabled, 1},
 			{"Fence2", MLit_Fence2, MdGlobal | MdHidden, 1},
 			{"HScrl", MLit_HorzScroll, MdGlobal | MdEnabled, -1},
+			{"Journal", MLit_Journal, MdGlobal | MdLocked, -1},
 			{"Line", MLit_LineDisp, MdHidden | MdInLine, -1},
 			{"Over", MLit_Overwrite, MdLocked, 2},
 			{"ReadOnly", MLit_ReadOnly, MdGlobal | MdLocked, -1},
@@ -649,6 +650,7 @@ static int editInit1(void) {
 			{"Repl", MLit_Replace, MdLocked, 2},
 			{"RtnMsg", MLit_RtnMsg, MdGlobal | MdLocked | MdHidden | MdEnabled, -1},
 			{"Safe", MLit_SafeSave, MdGlobal, -1},
+			{"Sync", MLit_SyncSave, MdGlobal, -1},
 			{"WkDir", MLit_WorkDir, MdGlobal | MdLocked | MdHidden | MdInLine, -1},
 			{"Wrap", MLit_Wrap, 0, -1},
 			{NULL, NULL, 0, -1}};
@@ -1338,16 +1340,23 @@ static int execute(int n, ushort extKey, KeyBind *pKeyBind) {
 					}
 				}
 ASaveChk:
-			// Save all changed buffers if auto-save mode and keystroke count reached.
-			if((modeInfo.cache[MdIdxASave]->flags & MdEnabled) && sess.autoSaveTrig > 0 &&
-			 --sess.autoSaveCount == 0) {
-				Datum sink;		// For throw-away return value, if any.
-				dinit(&sink);
-				keyEntry.prevFlags = keyEntry.curFlags;
-				keyEntry.curFlags = 0;
-				if(execCmdFunc(&sink, 1, cmdFuncTable + cf_saveFile, 0, 0) < Failure)
-					goto ErrRtn;
-				dclear(&sink);
+			// Save all changed buffers (or write their edit journals if "Journal" mode is enabled) if auto-save mode
+			// and keystroke count reached.
+			if(((modeInfo.cache[MdIdxASave]->flags | modeInfo.cache[MdIdxJournal]->flags) & MdEnabled) &&
+			 sess.autoSaveTrig > 0 && --sess.autoSaveCount == 0) {
+				if(modeInfo.cache[MdIdxJournal]->flags & MdEnabled) {
+					if(journalFlush() < Failure)
+						goto ErrRtn;
+					}
+				else {
+					Datum sink;		// For throw-away return value, if any.
+					dinit(&sink);
+					keyEntry.prevFlags = keyEntry.curFlags;
+					keyEntry.curFlags = 0;
+					if(execCmdFunc(&sink, 1, cmdFuncTable + cf_saveFile, 0, 0) < Failure)
+						goto ErrRtn;
+					dclear(&sink);
+					}
 				}
 			}
 		keyEntry.prevFlags = keyEntry.curFlags;
@@ -1390,6 +1399,13 @@ static int editLoop(void) {
 		if(agFree() != Success)			// and the array garbage.
 			break;
 
+		// Keep buffer memory within budget if a file was read or the budget was changed.
+		if(sess.opFlags & OpEvict) {
+			sess.opFlags &= ~OpEvict;
+			if(bevict() <= MinExit)
+				break;
+			}
+
 		// Fix up the screen.
 		if(update(INT_MIN) <= MinExit)
 			break;
@@ -1414,7 +1430,7 @@ JumpStart:
 			keyEntry.useLast = false;
 			}
 		else {
-			if(getKeySeq(false, &extKey, &pKeyBind, true) <= MinExit)
+			if(followWait() <= MinExit || getKeySeq(false, &extKey, &pKeyBind, true) <= MinExit)
 				break;
 			if(sess.rtn.status != Success)
 				goto Fail;
@@ -1773,9 +1789,10 @@ Retn:
 		Datum *pArrayEl;
 		Array *pArray = &bufTable;
 
-		// Display names (in line mode) of any files saved via quickExit().
+		// Display names (in line mode) of any files saved via quickExit() and delete any edit journals.
 		while((pArrayEl = aeach(&pArray)) != NULL) {
 			pBuf = bufPtr(pArrayEl);
+			journalEnd(pBuf, true);
 			if(pBuf->flags & BFQSave)
 				fprintf(stderr, text193, pBuf->filename);
 						// "Saved file \"%s\"\n"
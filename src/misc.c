@@ -165,25 +165,6 @@ void initCharTables(void) {
 		}
 	}
 
-// Get line number, given buffer and line pointer.
-long getLineNum(Buffer *pBuf, Line *pTargLine) {
-	Line *pLine;
-	long n;
-
-	// Start at the beginning of the buffer and count lines.
-	pLine = pBuf->pFirstLine;
-	n = 0;
-	do {
-		// If we have reached the target line, stop.
-		if(pLine == pTargLine)
-			break;
-		++n;
-		} while((pLine = pLine->next) != NULL);
-
-	// Return result.
-	return n + 1;
-	}
-
 // Return new column, given character in line and old column.
 int newCol(short c, int col) {
 
@@ -1435,13 +1416,13 @@ int chgMode1(const char *name, int action, Buffer *pBuf, long *formerStatep, Mod
 		return rsset(Failure, 0, text395, text389, name);
 				// "No such %s '%s'", "mode"
 
-	// Match found... validate mode and process it.  Error if (1), wrong type; or (2), ASave mode, $autoSave is zero, and
-	// setting mode or toggling it and ASave not currently set.
+	// Match found... validate mode and process it.  Error if (1), wrong type; or (2), ASave or Journal mode, $autoSave is
+	// zero, and setting mode or toggling it and mode not currently set.
 	if(((pModeSpec->flags & MdGlobal) != 0) != (pBuf == NULL))
 		return rsset(Failure, 0, text66, name);
 				// "Unknown or ambiguous mode '%s'"
-	if(pModeSpec == modeInfo.cache[MdIdxASave] && sess.autoSaveTrig == 0 &&
-	 (action > 0 || (action == 0 && !(pModeSpec->flags & MdEnabled))))
+	if((pModeSpec == modeInfo.cache[MdIdxASave] || pModeSpec == modeInfo.cache[MdIdxJournal]) &&
+	 sess.autoSaveTrig == 0 && (action > 0 || (action == 0 && !(pModeSpec->flags & MdEnabled))))
 		return rsset(Failure, RSNoFormat, text35);
 			// "$autoSave not set"
 
@@ -381,8 +381,19 @@ int moveLine(int n) {
 			// Flag this command as a line move...
 			keyEntry.curFlags |= SF_VertMove;
 
-			// and move point down.
+			// and move point down.  Use line index for a long move.
 			pLine = pPoint->pLine;
+			if(n > LineIdxBlkSize) {
+				Buffer *pBuf = sess.cur.pBuf;
+
+				if((pLine = getLinePtr(pBuf, getLineNum(pBuf, pLine) + n)) == NULL) {
+					pLine = pBuf->pFirstLine->prev;
+					status = NotFound;
+					pPoint->offset = pLine->used;
+					goto BufBound;
+					}
+				goto Goal;
+				}
 			do {
 				if(pLine->next == NULL) {
 					status = NotFound;
@@ -419,6 +430,7 @@ int moveLine(int n) {
 			}
 
 		// Reset the current position.
+Goal:
 		pPoint->offset = getGoal(pLine, targCol);
 BufBound:
 		pPoint->pLine = pLine;
@@ -730,15 +742,90 @@ ErrRetn:
 			// "%s(): Out of memory!"
 	pMark1->next = NULL;
 	pMark1->id = id;
+	pMark1->point.pLine = NULL;
 	pMark0->next = pMark1;
+	mregclear(sess.cur.pBuf);
 Found:
 	*ppMark = pMark1;
 	return sess.rtn.status;
 	}
 
+// Hash a Line pointer into a mark registry of given size.
+#define mreghash(pLine, size)	((uint) (((uintptr_t) (pLine) / sizeof(void *)) * 2654435761u) & ((size) - 1))
+
+// Free a mark registry.
+void mregfree(MarkReg *pMarkReg) {
+
+	free((void *) pMarkReg->table);
+	pMarkReg->table = NULL;
+	pMarkReg->size = 0;
+	pMarkReg->valid = false;
+	}
+
+// Rebuild mark registry for given buffer.  If memory for the hash table cannot be obtained, all marks are put into one chain.
+static void mregbuild(Buffer *pBuf) {
+	MarkReg *pMarkReg = &pBuf->markReg;
+	Mark *pMark, **ppMark;
+	uint size, count = 0;
+
+	// Size table to at least twice the number of marks.
+	pMark = &pBuf->markHdr;
+	do {
+		++count;
+		} while((pMark = pMark->next) != NULL);
+	for(size = 16; size < count * 2; size <<= 1);
+	if(size != pMarkReg->size) {
+		free((void *) pMarkReg->table);
+		if((pMarkReg->table = (Mark **) malloc(size * sizeof(Mark *))) == NULL) {
+			pMarkReg->size = 0;
+			goto Chain;
+			}
+		pMarkReg->size = size;
+		}
+	memset((void *) pMarkReg->table, 0, size * sizeof(Mark *));
+
+	// Add each mark to chain for its line via open addressing.
+	pMark = &pBuf->markHdr;
+	do {
+		ppMark = pMarkReg->table + mreghash(pMark->point.pLine, size);
+		while(*ppMark != NULL && (*ppMark)->point.pLine != pMark->point.pLine)
+			if(++ppMark == pMarkReg->table + size)
+				ppMark = pMarkReg->table;
+		pMark->pNextLineMark = *ppMark;
+		*ppMark = pMark;
+		} while((pMark = pMark->next) != NULL);
+	pMarkReg->valid = true;
+	return;
+Chain:
+	// Out of memory.  Chain all marks together.
+	pMark = &pBuf->markHdr;
+	do {
+		pMark->pNextLineMark = pMark->next;
+		} while((pMark = pMark->next) != NULL);
+	pMarkReg->valid = true;
+	}
+
+// Return chain of marks in given buffer that may be on given line (from mark registry), or NULL if none.  Caller must check
+// each mark's line.
+Mark *lineMarks(Buffer *pBuf, Line *pLine) {
+	MarkReg *pMarkReg = &pBuf->markReg;
+	Mark **ppMark;
+
+	if(!pMarkReg->valid)
+		mregbuild(pBuf);
+	if(pMarkReg->size == 0)
+		return &pBuf->markHdr;
+	ppMark = pMarkReg->table + mreghash(pLine, pMarkReg->size);
+	while(*ppMark != NULL && (*ppMark)->point.pLine != pLine)
+		if(++ppMark == pMarkReg->table + pMarkReg->size)
+			ppMark = pMarkReg->table;
+	return *ppMark;
+	}
+
 // Set given mark to point in given window.
 void setWindMark(Mark *pMark, EWindow *pWind) {
 
+	mregclear(pWind->pBuf);
 	pMark->point = pWind->face.point;
 	pMark->reframeRow = getWindPos(pWind);
 	}
@@ -864,6 +951,7 @@ static int delMark1(Mark *pMark) {
 		}
 	pMark0->next = pMark->next;
 	free((void *) pMark);
+	mregclear(sess.cur.pBuf);
 	return rsset(Success, RSHigh | RSTermAttr, "%s~u%c~U %s", text9, id, text10);
 							// "Mark ", "deleted"
 	}
@@ -913,6 +1001,7 @@ static int swapMrk(Mark *pMark, bool forceReframe) {
 	short oldRow = getWindPos(sess.cur.pWind);
 	goMark(pMark, forceReframe);
 	pMark->point = oldPoint;
+	mregclear(sess.cur.pBuf);
 	pMark->reframeRow = oldRow;
 	return sess.rtn.status;
 	}
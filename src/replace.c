@@ -621,6 +621,7 @@ Rpt:
 		if(findBufMark(WorkMark, &pMark, MKCreate) != Success)
 			return sess.rtn.status;
 		pMark->point = queryCtrl.origPoint.point;
+		mregclear(sess.cur.pBuf);
 		pMark->reframeRow = queryCtrl.origPoint.reframeRow;
 
 		// Append to return message if it was set successfully.
@@ -29,6 +29,18 @@ typedef struct {
 	bool progMsgShown;		// Progress message displayed?
 	} BMScan;
 
+// Line-local plain text search kernel, used by scan() when the pattern does not contain a newline.  Text is searched with
+// memmem() if scanning forward in Exact mode, otherwise with a Boyer-Moore-Horspool loop over case-folded characters.
+typedef struct {
+	const char *pat;		// Pattern (folded to lower case if ignoring case).
+	int patLen;			// Length of pattern.
+	const char *fold;		// Case-folding table (lowCase), or NULL if Exact mode.
+	int shift[256];			// Horspool shift for each (folded) character.
+	} LineKernel;
+
+static PatCache *patCache = NULL;	// Pattern cache list, most-recently-used first.
+static int patCacheCount = 0;		// Number of entries in pattern cache.
+
 // Control object for RE buffer searches.
 typedef struct {
 	Point point;			// Current line and offset in buffer during scan.
@@ -40,6 +52,13 @@ typedef struct {
 	bool progMsgShown;		// Progress message displayed?
 	} RegScan;
 
+// Control object for backward RE string scans, which read the source string in reverse in place via xreg[a]uexec() callbacks.
+typedef struct {
+	const char *str0;		// Beginning of source string (end of scan).
+	const char *start;		// Starting point (end of source string).
+	const char *point;		// Current scan point.
+	} StrScan;
+
 // Check if given search pattern has trailing option characters and return results.  Flags in *flags are initially cleared,
 // then if any options were found, the appropriate flags are set and the source string is truncated at the OptCh_Begin
 // character.  The final pattern length is returned.  The rule for interpreting a pattern is as follows: "If a pattern ends with
@@ -135,9 +154,117 @@ bool bufPlainSearch(void) {
 	return !bufRESearch() || !(bufSearch.match.flags & SRegical);
 	}
 
-// Compile search pattern for plain text buffer search and return status.
+// Free given pattern cache entry and its compiled patterns, and remove it from the cache.
+static void pcFree(PatCache *pCache) {
+
+	if(pCache->plain) {
+		if(pCache->flags & SCpl_ForwardBM)
+			bmfree(&pCache->u.bm.forwBM);
+		if(pCache->flags & SCpl_BackwardBM)
+			bmfree(&pCache->u.bm.backBM);
+		}
+	else {
+		if(pCache->flags & SCpl_ForwardRE)
+			xregfree(&pCache->u.regPat.compPat);
+		if(pCache->flags & SCpl_BackwardRE)
+			xregfree(&pCache->u.regPat.compBackPat);
+		}
+	if(pCache->prev == NULL)
+		patCache = pCache->next;
+	else
+		pCache->prev->next = pCache->next;
+	if(pCache->next != NULL)
+		pCache->next->prev = pCache->prev;
+	free((void *) pCache);
+	--patCacheCount;
+	}
+
+// Evict least-recently-used entries that are not in use from the pattern cache until it holds no more than PatCacheMax entries.
+static void pcTrim(void) {
+	PatCache *pCache, *pCache1;
+
+	if(patCacheCount > PatCacheMax) {
+
+		// Find tail of list, then free unused entries from there toward the head.
+		for(pCache = patCache; pCache->next != NULL; pCache = pCache->next);
+		do {
+			pCache1 = pCache->prev;
+			if(pCache->useCount == 0)
+				pcFree(pCache);
+			} while((pCache = pCache1) != NULL && patCacheCount > PatCacheMax);
+		}
+	}
+
+// Find entry in pattern cache for given pattern, type (plain text or RE), and compilation flags, creating an empty one if not
+// found, make it the most recently used, and add a user to it.  Return pointer to entry, or NULL if error (with exception set).
+static PatCache *pcGet(const char *pat, int patLen, bool plain, int compFlags) {
+	PatCache *pCache;
+
+	for(pCache = patCache; pCache != NULL; pCache = pCache->next)
+		if(pCache->plain == plain && pCache->compFlags == compFlags && pCache->patLen == patLen &&
+		 memcmp(pCache->pat, pat, patLen) == 0) {
+
+			// Found it.  Move it to the front.
+			if(pCache->prev != NULL) {
+				if((pCache->prev->next = pCache->next) != NULL)
+					pCache->next->prev = pCache->prev;
+				goto Link;
+				}
+			goto Found;
+			}
+
+	// Not found: create new entry.
+	if((pCache = (PatCache *) malloc(sizeof(PatCache) + patLen + 1)) == NULL) {
+		(void) rsset(Panic, 0, text94, "pcGet");
+			// "%s(): Out of memory!"
+		return NULL;
+		}
+	memcpy(pCache->pat = (char *) (pCache + 1), pat, patLen);
+	pCache->pat[patLen] = '\0';
+	pCache->patLen = patLen;
+	pCache->plain = plain;
+	pCache->compFlags = compFlags;
+	pCache->flags = 0;
+	pCache->useCount = 0;
+	++patCacheCount;
+Link:
+	pCache->prev = NULL;
+	if((pCache->next = patCache) != NULL)
+		patCache->prev = pCache;
+	patCache = pCache;
+Found:
+	++pCache->useCount;
+	pcTrim();
+	return pCache;
+	}
+
+// Remove a user from given pattern cache entry.  If it is no longer in use, free it if nothing was compiled in it (because
+// compilation failed); otherwise, keep it for reuse unless the cache is full.
+static void pcRelease(PatCache *pCache) {
+
+	if(--pCache->useCount == 0) {
+		if(!(pCache->flags & (SCpl_ForwardBM | SCpl_BackwardBM | SCpl_ForwardRE | SCpl_BackwardRE)))
+			pcFree(pCache);
+		else
+			pcTrim();
+		}
+	}
+
+// Release plain text pattern compilation.
+static void freeBM(void) {
+
+	if(bufSearch.pBMCache != NULL) {
+		pcRelease(bufSearch.pBMCache);
+		bufSearch.pBMCache = NULL;
+		}
+	bufSearch.match.flags &= ~(SCpl_ForwardBM | SCpl_BackwardBM);
+	}
+
+// Compile search pattern for plain text buffer search and return status.  Compiled patterns are obtained from the pattern
+// cache (see pcGet()) if possible.
 int compileBM(ushort flags) {
-	unsigned compFlags;
+	int compFlags;
+	PatCache *pCache;
 	Match *pMatch = &bufSearch.match;
 
 	// Remember type of compile.
@@ -152,43 +279,48 @@ int compileBM(ushort flags) {
 
 	// Compile forward and backward patterns if requested.
 	if(flags & SCpl_ForwardBM) {
+		freeBM();
+		if((bufSearch.pBMCache = pcGet(pMatch->pat, pMatch->patLen, true, compFlags)) == NULL)
+			return sess.rtn.status;
+		if(!(bufSearch.pBMCache->flags & SCpl_ForwardBM)) {
 #if MMDebug & Debug_Regexp
-		fprintf(logfile, "compileBM(): compiling pattern '%s' with compFlags %.8x...\n",
-		 pMatch->pat, compFlags);
+			fprintf(logfile, "compileBM(): compiling pattern '%s' with compFlags %.8x...\n",
+			 pMatch->pat, compFlags);
 #endif
-		if(bmncomp(&bufSearch.forwBM, pMatch->pat, pMatch->patLen, compFlags) != 0)
-			goto LibFail;
+			if(bmncomp(&bufSearch.pBMCache->u.bm.forwBM, pMatch->pat, pMatch->patLen, compFlags) != 0)
+				goto LibFail;
+			bufSearch.pBMCache->flags |= SCpl_ForwardBM;
+			}
+		bufSearch.forwBM = bufSearch.pBMCache->u.bm.forwBM;
+		pMatch->flags |= SCpl_ForwardBM;
 		}
 	if(flags & SCpl_BackwardBM) {
-		if(bmncomp(&bufSearch.backBM, pMatch->pat, pMatch->patLen, compFlags | PatReverse) != 0)
+		pCache = bufSearch.pBMCache;
+		if(!(pCache->flags & SCpl_BackwardBM)) {
+			if(bmncomp(&pCache->u.bm.backBM, pMatch->pat, pMatch->patLen, pCache->compFlags | PatReverse) != 0)
 LibFail:
-			return libfail();
+				return libfail();
+			pCache->flags |= SCpl_BackwardBM;
+			}
+		bufSearch.backBM = pCache->u.bm.backBM;
+		pMatch->flags |= SCpl_BackwardBM;
 		}
 	return sess.rtn.status;
 	}
 
-// Free all heap space for plain text pattern compilation.
-static void freeBM(void) {
-	Match *pMatch = &bufSearch.match;
-
-	if(pMatch->flags & SCpl_ForwardBM) {
-		bmfree(&bufSearch.forwBM);
-		if(pMatch->flags & SCpl_BackwardBM)
-			bmfree(&bufSearch.backBM);
-		pMatch->flags &= ~(SCpl_ForwardBM | SCpl_BackwardBM);
-		}
-	}
-
-// Free all heap space for RE pattern in given Match object.
+// Release RE pattern compilation in given Match object.
 void freeRE(Match *pMatch) {
 
-	if(pMatch->flags & SCpl_ForwardRE) {
-		xregfree(&pMatch->regPat.compPat);
-		if(pMatch->flags & SCpl_BackwardRE)
-			xregfree(&pMatch->regPat.compBackPat);
-		pMatch->flags &= ~(SCpl_ForwardRE | SCpl_BackwardRE);
+	if(pMatch->pCache != NULL) {
+		pcRelease(pMatch->pCache);
+		pMatch->pCache = NULL;
 		pMatch->grpCount = 0;
 		}
+	pMatch->flags &= ~(SCpl_ForwardRE | SCpl_BackwardRE);
+	if(pMatch == &bufSearch.match) {
+		bufSearch.reLineLocal = false;
+		bufSearch.reLitLen = 0;
+		}
 	}
 
 // Check if search pattern contains any regular expression metacharacters and set or clear SRegical flag accordingly.
@@ -202,6 +334,134 @@ static void metaCheck(Match *pMatch) {
 	pMatch->flags &= ~SRegical;
 	}
 
+// Skip over quantifier at given position in RE pattern, if any, and return pointer to following character.
+static const char *reSkipQuant(const char *str) {
+
+	for(;;) {
+		switch(*str) {
+			case MC_Closure0:
+			case MC_Closure1:
+			case MC_Closure01:
+				++str;
+				break;
+			case MC_ClBegin:
+				while(*str != '\0' && *str++ != MC_ClEnd);
+				break;
+			default:
+				return str;
+			}
+		}
+	}
+
+// Skip over character class beginning after the MC_CCBegin character at given position in RE pattern and return pointer to
+// following character.
+static const char *reSkipClass(const char *str) {
+	const char *str1;
+
+	if(*str == MC_NegCC)
+		++str;
+	if(*str == MC_CCEnd)
+		++str;
+	while(*str != '\0' && *str != MC_CCEnd) {
+		if(*str++ == MC_CCBegin && *str == ':') {
+			if((str1 = strstr(str, ":]")) == NULL)
+				return strchr(str, '\0');
+			str = str1 + 2;
+			}
+		}
+	return (*str == '\0') ? str : str + 1;
+	}
+
+// Determine if the buffer search RE pattern in given Match object can never match a newline and set bufSearch.reLineLocal
+// accordingly, so that regScan() may scan one line at a time.  Multi and Fuzzy modes, control characters, escaped letters other
+// than \w, \d, \b, and \B, classes that include newline, and group options disqualify the pattern.  If it qualifies, also find
+// the longest literal that every match must contain, store it in bufSearch.reLit (truncated to RELitMax bytes), and set
+// bufSearch.reLitLen to its length, so that regScan() can skip lines that do not contain it.  Literals inside groups and
+// escaped letters and digits (which may be back references) are not considered.
+static void reLiteral(Match *pMatch) {
+	short c;
+	int depth;
+	const char *str;
+	char run[RELitMax];
+	int runLen = 0;
+
+	bufSearch.reLineLocal = false;
+	bufSearch.reLitLen = 0;
+#if FuzzySearch
+	if(pMatch->flags & (SOpt_Multi | SOpt_Fuzzy))
+#else
+	if(pMatch->flags & SOpt_Multi)
+#endif
+		return;
+
+	// Check if pattern can match a newline.
+	for(str = pMatch->pat; (c = *str) != '\0'; ++str) {
+		if(c < ' ' || (c == MC_GrpBegin && str[1] == MC_OptBegin && str[2] != MC_NonCapt))
+			return;
+		if(c == MC_Escape && ((c = *++str) == '\0' || (is_letter(c) && strchr("wdbB", c) == NULL)))
+			return;
+		}
+	if(strstr(pMatch->pat, ":space:") != NULL || strstr(pMatch->pat, ":cntrl:") != NULL)
+		return;
+	bufSearch.reLineLocal = true;
+
+	// Find longest run of mandatory literal characters at top level.
+	str = pMatch->pat;
+	for(;;) {
+		switch(c = *str++) {
+			case MC_Escape:
+				if(is_letter(c = *str++) || is_digit(c) || c == MC_BOW || c == MC_EOW)
+					goto EndRun;
+				goto Literal;
+			case MC_OrBar:
+				bufSearch.reLitLen = 0;			// Top-level alternative: no literal is mandatory.
+				return;
+			case MC_GrpBegin:
+				depth = 1;
+				while(depth > 0 && (c = *str) != '\0') {
+					++str;
+					if(c == MC_Escape)
+						++str;
+					else if(c == MC_CCBegin)
+						str = reSkipClass(str);
+					else if(c == MC_GrpBegin)
+						++depth;
+					else if(c == MC_GrpEnd)
+						--depth;
+					}
+				str = reSkipQuant(str);
+				goto EndRun;
+			case MC_CCBegin:
+				str = reSkipQuant(reSkipClass(str));
+				goto EndRun;
+			case MC_Closure0:
+			case MC_Closure1:
+			case MC_Closure01:
+			case MC_ClBegin:
+				str = reSkipQuant(str - 1);
+				// Fall through.
+			case '\0':
+			case MC_Any:
+			case MC_BOL:
+			case MC_EOL:
+				goto EndRun;
+			}
+Literal:
+		// Literal character.  Exclude it if it is optional or repeated a variable number of times.
+		if(*str == MC_Closure0 || *str == MC_Closure01 || *str == MC_ClBegin)
+			goto EndRun;
+		if(runLen < RELitMax)
+			run[runLen++] = c;
+		continue;
+EndRun:
+		if(runLen > bufSearch.reLitLen)
+			memcpy(bufSearch.reLit, run, bufSearch.reLitLen = runLen);
+		runLen = 0;
+		if(c == '\0')
+			break;
+		}
+	}
+
 // Set error message pertaining to code r returned from XRE library function and return Failure status.
 static int regError(const char *pat, int r) {
 	const char *text;
@@ -242,10 +502,11 @@ SetMsg:
 	}
 
 // Compile the RE string in the given Match object forward and/or backward per "flags", save in the "regPat" member, and return
-// status.  The RE string is assumed to be non-empty, and memory used for any previous compile is assumed to have already been
-// freed.  If SCpl_ForwardRE is set in flags, the forward pattern is compiled and the backward pattern is created.  If
-// SCpl_BackwardRE is set in flags, the backward pattern is compiled (and is assumed to already exist).  In either case, if the
-// buffer Match object is being processed and the pattern contains no metacharacters, compilation is skipped.
+// status.  The RE string is assumed to be non-empty.  Compiled patterns are obtained from the pattern cache (see pcGet()) if
+// possible, and any previous forward compile is released.  If SCpl_ForwardRE is set in flags, the forward pattern is compiled
+// and the backward pattern is created.  If SCpl_BackwardRE is set in flags, the backward pattern is compiled (and is assumed to
+// already exist).  In either case, if the buffer Match object is being processed and the pattern contains no metacharacters,
+// compilation is skipped.
 int compileRE(Match *pMatch, ushort flags) {
 
 	// If compiling primary (forward) pattern, check if new pattern contains any metacharacters.
@@ -255,6 +516,7 @@ int compileRE(Match *pMatch, ushort flags) {
 	// Proceed with compilation if non-buffer type or have metacharacter(s) in new pattern.
 	if(pMatch != &bufSearch.match || (pMatch->flags & SRegical)) {
 		int r, compFlags;
+		PatCache *pCache;
 
 		// Set XRE compilation flags.
 		compFlags = REG_ENHANCED | REG_NEWLINE | REG_APPROX;
@@ -267,25 +529,38 @@ int compileRE(Match *pMatch, ushort flags) {
 		if(pMatch->flags & SOpt_Multi)
 			compFlags |= REG_ANY;
 
-		// Compile new forward pattern and/or backward pattern.
+		// Get cache entry for new forward pattern and compile it if needed, and/or compile backward pattern if needed.
+		// Compiled patterns are copied from cache entry.
 		if(flags & SCpl_ForwardRE) {
+			freeRE(pMatch);
+			if((pCache = pcGet(pMatch->pat, strlen(pMatch->pat), false, compFlags)) == NULL)
+				return sess.rtn.status;
+			pMatch->pCache = pCache;
+			if(!(pCache->flags & SCpl_ForwardRE)) {
 #if MMDebug & Debug_Regexp
-			fprintf(logfile, "compileRE(): compiling pattern '%s' with compFlags %.8x...\n",
-			 pMatch->pat, compFlags);
+				fprintf(logfile, "compileRE(): compiling pattern '%s' with compFlags %.8x...\n",
+				 pMatch->pat, compFlags);
 #endif
-			if((r = xregcomp(&pMatch->regPat.compPat, pMatch->pat, compFlags)) == 0) {
-				pMatch->flags |= SCpl_ForwardRE;
-				pMatch->grpCount = pMatch->regPat.compPat.re_nsub;
+				if((r = xregcomp(&pCache->u.regPat.compPat, pMatch->pat, compFlags)) != 0)
+					goto CompErr;
+				pCache->flags |= SCpl_ForwardRE;
 				}
-			else
-				goto CompErr;
+			pMatch->regPat.compPat = pCache->u.regPat.compPat;
+			pMatch->flags |= SCpl_ForwardRE;
+			pMatch->grpCount = pCache->u.regPat.compPat.re_nsub;
+			if(pMatch == &bufSearch.match)
+				reLiteral(pMatch);
 			}
 		if(flags & SCpl_BackwardRE) {
-			if((r = xregcomp(&pMatch->regPat.compBackPat, pMatch->pat, compFlags | REG_REVERSE)) == 0)
-				pMatch->flags |= SCpl_BackwardRE;
-			else
+			pCache = pMatch->pCache;
+			if(!(pCache->flags & SCpl_BackwardRE)) {
+				if((r = xregcomp(&pCache->u.regPat.compBackPat, pMatch->pat, pCache->compFlags | REG_REVERSE)) != 0)
 CompErr:
-				return regError(pMatch->pat, r);
+					return regError(pMatch->pat, r);
+				pCache->flags |= SCpl_BackwardRE;
+				}
+			pMatch->regPat.compBackPat = pCache->u.regPat.compBackPat;
+			pMatch->flags |= SCpl_BackwardRE;
 			}
 		}
 
@@ -334,6 +609,7 @@ void minit(Match *pMatch) {
 	pMatch->flags = pMatch->grpCount = pMatch->grpMatch.size = 0;
 	pMatch->searchPatSize = pMatch->replPatSize = 0;
 	pMatch->compReplPat = NULL;
+	pMatch->pCache = NULL;
 	pMatch->grpMatch.groups = NULL;
 	}
 
@@ -806,9 +1082,154 @@ static bool bmGetNext(short *pChar, void *context) {
 	return false;
 	}
 
+// Initialize given LineKernel object for scanning in given direction for given pattern.  If "exact" is false, the pattern is
+// folded to lower case into patBuf (which must be at least patLen bytes).
+static void lkInit(LineKernel *pKern, const char *pat, int patLen, bool exact, ushort direct, char *patBuf) {
+	int i;
+	int *pShift, *pShiftEnd;
+
+	pKern->patLen = patLen;
+	if(exact) {
+		pKern->pat = pat;
+		pKern->fold = NULL;
+		}
+	else {
+		for(i = 0; i < patLen; ++i)
+			patBuf[i] = lowCase[(uchar) pat[i]];
+		pKern->pat = patBuf;
+		pKern->fold = lowCase;
+		}
+
+	// Build shift table.  Forward, the last character of the window determines the shift; backward, the first one does.
+	pShiftEnd = (pShift = pKern->shift) + 256;
+	do {
+		*pShift++ = patLen;
+		} while(pShift < pShiftEnd);
+	if(direct == Forward) {
+		for(i = 0; i < patLen - 1; ++i)
+			pKern->shift[(uchar) pKern->pat[i]] = patLen - 1 - i;
+		}
+	else {
+		for(i = patLen - 1; i > 0; --i)
+			pKern->shift[(uchar) pKern->pat[i]] = i;
+		}
+	}
+
+// Compare len bytes of given text with given (folded) pattern text and return true if equal.
+static bool lkEqual(LineKernel *pKern, const char *text, const char *pat, int len) {
+	const char *textEnd;
+
+	if(pKern->fold == NULL)
+		return memcmp(text, pat, len) == 0;
+	for(textEnd = text + len; text < textEnd; ++text)
+		if(pKern->fold[(uchar) *text] != *pat++)
+			return false;
+	return true;
+	}
+
+// Find first (if scanning forward) or last (if scanning backward) occurrence of pattern in given text.  Return pointer to
+// beginning of match, or NULL if not found.
+static const char *lkFind(LineKernel *pKern, const char *text, int len, ushort direct) {
+	int pos, c;
+	int lastIdx = pKern->patLen - 1;
+
+	if(direct == Forward) {
+		if(pKern->fold == NULL)
+			return (const char *) memmem((const void *) text, len, (const void *) pKern->pat, pKern->patLen);
+		for(pos = 0; pos + lastIdx < len; pos += pKern->shift[c]) {
+			c = (uchar) pKern->fold[(uchar) text[pos + lastIdx]];
+			if(c == (uchar) pKern->pat[lastIdx] && lkEqual(pKern, text + pos, pKern->pat, lastIdx))
+				return text + pos;
+			}
+		}
+	else {
+		for(pos = len - pKern->patLen; pos >= 0; pos -= pKern->shift[c]) {
+			c = (uchar) text[pos];
+			if(pKern->fold != NULL)
+				c = (uchar) pKern->fold[c];
+			if(c == (uchar) *pKern->pat && lkEqual(pKern, text + pos + 1, pKern->pat + 1, lastIdx))
+				return text + pos;
+			}
+		}
+	return NULL;
+	}
+
+// Display progress message if given number of characters scanned has reached CharScanCount and message not already shown.
+static void scanProgress(uint scanCount, bool *pProgMsgShown) {
+
+	if(!*pProgMsgShown && scanCount >= CharScanCount) {
+		(void) mlputs(MLHome | MLWrap | MLFlush, text203);
+				// "Searching..."
+		*pProgMsgShown = true;
+		}
+	}
+
+// Move given point to beginning of next line (if scanning forward) or end of previous line (if scanning backward), counting
+// the line break against *pLineBreakLimit (if not zero).  Return false if a buffer boundary is hit or the line break limit is
+// reached; otherwise, true.
+static bool lineNext(Point *pPoint, ushort direct, int *pLineBreakLimit) {
+
+	if(direct == Forward) {
+		if(pPoint->pLine->next == NULL || (*pLineBreakLimit && --*pLineBreakLimit == 0))
+			return false;
+		pPoint->pLine = pPoint->pLine->next;
+		pPoint->offset = 0;
+		}
+	else {
+		if(pPoint->pLine == sess.cur.pBuf->pFirstLine || (*pLineBreakLimit && --*pLineBreakLimit == 0))
+			return false;
+		pPoint->pLine = pPoint->pLine->prev;
+		pPoint->offset = pPoint->pLine->used;
+		}
+	return true;
+	}
+
+// Scan current buffer for next occurrence of pattern with given LineKernel object, one line at a time, beginning at given
+// point and scanning in given direction.  Lines skipped are counted against *pLineBreakLimit (if not zero) and added to
+// *pScanCount for progress reporting.  If match found, leave point at the beginning (if scanning forward) or end (if scanning
+// backward) of the part of the line that was searched and return pointer to beginning of match in line text; otherwise,
+// return NULL if a buffer boundary is hit or the line break limit is reached.
+static const char *lineFind(LineKernel *pKern, Point *pPoint, ushort direct, int *pLineBreakLimit, uint *pScanCount,
+ bool *pProgMsgShown) {
+	const char *match;
+
+	for(;;) {
+		if(direct == Forward) {
+			if((match = lkFind(pKern, pPoint->pLine->text + pPoint->offset, pPoint->pLine->used - pPoint->offset,
+			 Forward)) != NULL)
+				break;
+			*pScanCount += pPoint->pLine->used - pPoint->offset + 1;
+			}
+		else {
+			if((match = lkFind(pKern, pPoint->pLine->text, pPoint->offset, Backward)) != NULL)
+				break;
+			*pScanCount += pPoint->offset + 1;
+			}
+		if(!lineNext(pPoint, direct, pLineBreakLimit))
+			return NULL;
+		scanProgress(*pScanCount, pProgMsgShown);
+		}
+
+	return match;
+	}
+
+// Scan current buffer for next occurrence of plain text pattern with given LineKernel object, beginning at scanning point in
+// given BMScan object.  If match found, leave scanning point at end (if scanning forward) or beginning (if scanning backward)
+// of matched text, as bmuexec() does, and return true; otherwise, return false.
+static bool lineScan(LineKernel *pKern, BMScan *pScan) {
+	const char *match;
+
+	if((match = lineFind(pKern, &pScan->point, pScan->direct, &pScan->lineBreakLimit, &pScan->scanCount,
+	 &pScan->progMsgShown)) == NULL)
+		return false;
+	pScan->point.offset = match - pScan->point.pLine->text + (pScan->direct == Forward ? pKern->patLen : 0);
+	return true;
+	}
+
 // Search current buffer for the nth occurrence of text matching a regular expression in either direction.  (It is assumed that
 // n > 0.)  If match found, position point at the beginning (if scanning backward) or end (if scanning forward) the matched text
-// and set *pMatchLen to text length (if matchLen not NULL).  Uses fast Apostolico-Giancarlo search algorithm from CXL library,
+// and set *pMatchLen to text length (if matchLen not NULL).  If the pattern does not contain a newline, each line's text is
+// searched directly by lineScan(); otherwise, uses fast Apostolico-Giancarlo search algorithm from CXL library,
 // which is a variant of the Boyer-Moore algorithm.  "n" is repeat count, "pLineBreakLimit" is pointer to number of line breaks
 // that forces failure, and "direct" is Forward or Backward.  Return NotFound (bypassing rsset()) if search failure.
 int scan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
@@ -819,6 +1240,9 @@ int scan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 	Match *pMatch = &bufSearch.match;
 	MatchLoc matchLoc;
 	BMPat *pPat = (direct == Forward) ? &bufSearch.forwBM : &bufSearch.backBM;
+	LineKernel kern;
+	char kernPat[pMatch->patLen];
+	bool lineLocal = memchr(pMatch->pat, '\n', pMatch->patLen) == NULL;
 #if MMDebug & Debug_SrchRepl
 	char patBuf[pMatch->patLen + OptCh_N + 1];
 	makePat(patBuf, &bufSearch.match);
@@ -833,6 +1257,8 @@ int scan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 	bmScan.direct = direct;
 	matchLoc.region.size = pMatch->patLen;
 	matchLoc.region.lineCount = 0;					// Not used.
+	if(lineLocal)
+		lkInit(&kern, pMatch->pat, pMatch->patLen, pMatch->flags & SCpl_PlainExact, direct, kernPat);
 
 	// Scan the buffer until we find the nth match or hit a buffer boundary.
 	for(;;) {
@@ -845,11 +1271,11 @@ int scan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 #endif
 		// Ready to roll... scan the buffer for a match.
 #if MMDebug & Debug_SrchRepl
-		offset = bmuexec(pPat, bmGetNext, (void *) &bmScan);
+		offset = lineLocal ? (lineScan(&kern, &bmScan) ? 0 : -1) : bmuexec(pPat, bmGetNext, (void *) &bmScan);
 		fprintf(logfile, "  bmuexec() returned offset %ld\n", offset);
 		if(offset >= 0) {	/*** } ***/
 #else
-		if(bmuexec(pPat, bmGetNext, (void *) &bmScan) >= 0) {
+		if(lineLocal ? lineScan(&kern, &bmScan) : bmuexec(pPat, bmGetNext, (void *) &bmScan) >= 0) {
 #endif
 			// A SUCCESSFULL MATCH!  Flag that we have moved, update the point pointers, and save the match.  Need
 			// to do this now because the nth match may not be found, in which case we want to leave the point at
@@ -988,13 +1414,83 @@ static int getExecFlags(ushort direct, bool atBeginEnd, short c) {
 	return execFlags;
 	}
 
+// Run RE directly on the text of the current line in given RegScan object from the scanning point to the end of the line (if
+// scanning forward) or from the beginning of the line to the scanning point (if scanning backward, in which case the text is
+// reversed into a work buffer for the backward pattern).  Forward, the text is scanned in place if the line has room for a
+// terminating null; otherwise, it is copied.  If a match is found, leave scanning point at end of match and set offset as
+// regGetNext() would have.  Return xregexec() status, or -1 if the text contains a null byte (which xregexec() cannot scan).
+static int regLineExec(regex_t *pRegex, RegScan *pRegScan, size_t groupCount) {
+	static char *workBuf = NULL;		// Work buffer (on heap), grown as needed.
+	static int workBufSize = 0;
+	int r, len;
+	char *str;
+	const char *src, *srcEnd;
+	Point *pPoint = &pRegScan->point;
+	Line *pLine = pPoint->pLine;
+	ushort direct = pRegScan->regMatch.direct;
+
+	if(direct == Forward) {
+		src = pLine->text + pPoint->offset;
+		len = pLine->used - pPoint->offset;
+		r = getExecFlags(Forward, pPoint->offset == 0, pPoint->offset == 0 ? '\0' : src[-1]);
+		}
+	else {
+		src = pLine->text;
+		len = pPoint->offset;
+		r = getExecFlags(Backward, len == pLine->used, len == pLine->used ? '\0' : src[len]);
+		}
+	if(memchr(src, '\0', len) != NULL)
+		return -1;
+
+	// Get null-terminated text.
+	if(direct == Forward && pLine->size > pLine->used) {
+		str = (char *) src;
+		pLine->text[pLine->used] = '\0';
+		}
+	else {
+		if(len >= workBufSize) {
+			int size = (len + 1 > workBufSize * 2) ? len + 1 : workBufSize * 2;
+			if((str = (char *) realloc((void *) workBuf, size)) == NULL)
+				return REG_ESPACE;
+			workBuf = str;
+			workBufSize = size;
+			}
+		if(direct == Forward)
+			memcpy(workBuf, src, len);
+		else {
+			str = workBuf;
+			for(srcEnd = src + len; srcEnd > src; )
+				*str++ = *--srcEnd;
+			}
+		workBuf[len] = '\0';
+		str = workBuf;
+		}
+
+	// Scan it.
+	pRegScan->scanCount += len + 1;
+	scanProgress(pRegScan->scanCount, &pRegScan->progMsgShown);
+	if((r = xregexec(pRegex, str, groupCount, pRegScan->regMatch.grpList, r)) == 0) {
+		pRegScan->offset = pRegScan->regMatch.grpList->rm_eo;
+		pPoint->offset += (direct == Forward) ? pRegScan->offset : -pRegScan->offset;
+		}
+	return r;
+	}
+
 // Search current buffer for the nth occurrence of text matching a regular expression in either direction.  (It is assumed that
 // n > 0.)  If match found, position point at the beginning (if scanning backward) or end (if scanning forward) the matched text
-// and set *pMatchLen to text length (if matchLen not NULL).  "n" is repeat count, "pLineBreakLimit" is pointer to number of
-// line breaks that forces failure, and "direct" is Forward or Backward.  Return NotFound (bypassing rsset()) if search failure.
+// and set *pMatchLen to text length (if matchLen not NULL).  If the pattern cannot match a newline (see reLiteral()), the RE is
+// run on the text of one line at a time by regLineExec(), and if it also has a required literal, lines that do not contain it
+// are skipped with lineFind(); otherwise, the buffer is scanned as a character stream by xreg[a]uexec().  "n" is repeat count,
+// "pLineBreakLimit" is pointer to number of line breaks that forces failure, and "direct" is Forward or Backward.  Return
+// NotFound (bypassing rsset()) if search failure.
 int regScan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 	int r;
 	short c;
+	int lineBreakLimit;
+	LineKernel kern;
+	char kernPat[RELitMax];
+	bool lineLocal = bufSearch.reLineLocal;
+	bool prefilter = bufSearch.reLitLen > 0;
 	RegScan regScan;
 	Match *pMatch = &bufSearch.match;
 	regex_t *pRegex = (direct == Forward) ? &pMatch->regPat.compPat : &pMatch->regPat.compBackPat;
@@ -1024,9 +1520,16 @@ int regScan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 	regScan.regMatch.grpList = groups;
 	regScan.regMatch.direct = direct;
 	regScan.regMatch.startPoint.type = ScanPt_Buf;
+	if(prefilter)
+		lkInit(&kern, bufSearch.reLit, bufSearch.reLitLen, pMatch->flags & SCpl_RegExact, direct, kernPat);
 
 	// Scan the buffer until we find the nth match or hit a buffer boundary.
 	for(;;) {
+		// If prefiltering, skip to next line containing the literal.
+		if(prefilter && lineFind(&kern, &regScan.point, direct, &regScan.lineBreakLimit, &regScan.scanCount,
+		 &regScan.progMsgShown) == NULL)
+			break;
+
 		// Save the current position (starting point) so we can find the exact match point and save group matches later
 		// if match is successful.
 		regScan.regMatch.startPoint.u.bufPoint = regScan.point;
@@ -1040,30 +1543,32 @@ int regScan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 		 direct == Forward ? "for" : "back", pMatch->pat, (int)(regScan.point.pLine->used - regScan.point.offset),
 		 regScan.point.pLine->text + regScan.point.offset);
 #endif
-		// Ready to roll... scan the buffer for a match.
-		if((c = nextChar(&regScan.point, direct ^ 1, false)) < 0)
-			c = '\0';
-		r = getExecFlags(direct, direct == Forward ? regScan.point.offset == 0 :
-		 regScan.point.offset == regScan.point.pLine->used, c);
+		// Ready to roll... scan the current line or the buffer for a match.  A line containing a null byte is scanned as a
+		// stream which is confined to the line.
+		if(!lineLocal || (r = regLineExec(pRegex, &regScan, pMatch->grpCount + 1)) < 0) {
+			lineBreakLimit = regScan.lineBreakLimit;
+			if(lineLocal)
+				regScan.lineBreakLimit = 1;
+			if((c = nextChar(&regScan.point, direct ^ 1, false)) < 0)
+				c = '\0';
+			r = getExecFlags(direct, direct == Forward ? regScan.point.offset == 0 :
+			 regScan.point.offset == regScan.point.pLine->used, c);
 #if FuzzySearch
+			r = (pMatch->flags & SOpt_Fuzzy) ? xregauexec(pRegex, &strSource, &approxMatch, &params, r) :
+			 xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
 #if MMDebug & Debug_SrchRepl
-		r = (pMatch->flags & SOpt_Fuzzy) ? xregauexec(pRegex, &strSource, &approxMatch, &params, r) :
-		 xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
-		fprintf(logfile, "  xreg%suexec() returned status %d\n", (pMatch->flags & SOpt_Fuzzy) ? "a" : "", r);
-		if(r == 0) {
-#else
-		if((r = (pMatch->flags & SOpt_Fuzzy) ? xregauexec(pRegex, &strSource, &approxMatch, &params, r) :
-		 xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r)) == 0) {
+			fprintf(logfile, "  xreg%suexec() returned status %d\n", (pMatch->flags & SOpt_Fuzzy) ? "a" : "", r);
 #endif
 #else
+			r = xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
 #if MMDebug & Debug_SrchRepl
-		r = xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
-		fprintf(logfile, "  xreguexec() returned status %d\n", r);
-		if(r == 0) {
-#else
-		if((r = xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r)) == 0) {
+			fprintf(logfile, "  xreguexec() returned status %d\n", r);
 #endif
 #endif
+			if(lineLocal)
+				regScan.lineBreakLimit = lineBreakLimit;
+			}
+		if(r == 0) {
 			// A SUCCESSFULL MATCH!  Flag that we have moved, update the point pointers, and save the match.
 #if MMDebug & Debug_SrchRepl
 			fprintf(logfile, "  -> rm_so %ld, rm_eo %ld, regScan.offset %ld\n",
@@ -1090,15 +1595,20 @@ int regScan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 #endif
 				}
 			}
-		else if(r == REG_NOMATCH)
-
-			// Not found.
-			break;
+		else if(r == REG_NOMATCH) {
+
+			// Not found.  If scanning lines, continue with next one.
+			if(!lineLocal)
+				break;
+			regScan.point = regScan.regMatch.startPoint.u.bufPoint;
+			if(!lineNext(&regScan.point, direct, &regScan.lineBreakLimit))
+				break;
+			}
 		else
 			// xreg[a]uexec() internal error.
 			return regError(pMatch->pat, r);
 
-		// Found match, but not nth one.  Continue searching.
+		// Found match, but not nth one (or line did not match).  Continue searching.
 		regScan.offset = 0;
 		}
 
@@ -1108,6 +1618,36 @@ int regScan(int n, int *pLineBreakLimit, ushort direct, long *pMatchLen) {
 	return NotFound;
 	}
 
+// Get next input character -- callback routine for xreg[a]uexec() in a backward string scan.  Set *pChar to the value of the
+// character preceding the scan point and set *pAdvBytes to 1.  Return true if beginning of string reached, otherwise false.
+static bool strGetNext(xint_t *pChar, uint *pAdvBytes, void *context) {
+	StrScan *pStrScan = (StrScan *) context;
+
+	*pAdvBytes = 1;
+	if(pStrScan->point == pStrScan->str0) {
+		*pChar = (xint_t) -1;
+		return true;
+		}
+	*pChar = (xint_t) (unsigned char) *--pStrScan->point;
+	return false;
+	}
+
+// Rewind input -- callback routine for xreg[a]uexec() in a backward string scan.  Reset the scan point to given offset from
+// the starting point.
+static void strRewind(regoff_t pos, void *context) {
+	StrScan *pStrScan = (StrScan *) context;
+
+	pStrScan->point = pStrScan->start - pos;
+	}
+
+// Compare strings -- callback routine for xreg[a]uexec() in a backward string scan.  Two substrings of the reversed input
+// are equal if the corresponding (forward) substrings of the source string are, so compare those in place.
+static int strCompare(regoff_t pos1, regoff_t pos2, size_t len, void *context) {
+	StrScan *pStrScan = (StrScan *) context;
+
+	return memcmp(pStrScan->start - pos1 - len, pStrScan->start - pos2 - len, len);
+	}
+
 // Compare given string in *pSrc with the (non-null) RE pattern in *pMatch.  If scanOffset < 0, begin comparison at end of
 // string and scan backward; otherwise, begin at scanOffset and scan forward.  If a match is found, set *result to regmatch_t
 // object (for group 0) and save groups in Match object; otherwise, set rm_so in *result to -1.  Return status.
@@ -1121,11 +1661,12 @@ int regcmp(Datum *pSrc, int scanOffset, Match *pMatch, regmatch_t *result) {
 	regamatch_t approxMatch = {pMatch->grpCount + 1, groups};
 	regaparams_t params;
 #endif
-	size_t srcLen = strlen(pSrc->str);
 	char *str;
-	char workBuf[srcLen + 1];		// For reversed string, if needed.
+	StrScan strScan;
+	regusource_t strSource = {
+		strGetNext, strRewind, strCompare, (void *) &strScan};
 
-	// Get ready.  If scanning backward, create local copy of reversed string and use backward RE pattern.
+	// Get ready.  If scanning backward, set up to read source string in reverse from its end and use backward RE pattern.
 #if FuzzySearch
 	if(pMatch->flags & SOpt_Fuzzy)
 		xregainit(&params, 0);
@@ -1138,7 +1679,8 @@ int regcmp(Datum *pSrc, int scanOffset, Match *pMatch, regmatch_t *result) {
 		c = (str > pSrc->str) ? str[-1] : '\0';
 		}
 	else {
-		str = strrev(strcpy(workBuf, pSrc->str));
+		strScan.str0 = str;
+		strScan.point = strScan.start = strchr(str, '\0');
 		regMatch.direct = Backward;
 		c = '\0';
 		}
@@ -1149,16 +1691,24 @@ int regcmp(Datum *pSrc, int scanOffset, Match *pMatch, regmatch_t *result) {
 	//		> 0	X	-
 	//	Bwd	strend	X	X
 	r = getExecFlags(regMatch.direct, regMatch.direct == Forward ? scanOffset == 0 || str[-1] == '\n' : true, c);
+	if(regMatch.direct == Forward)
 #if FuzzySearch
-	if((r = (pMatch->flags & SOpt_Fuzzy) ? xregaexec(pRegex, str, &approxMatch, &params, r) :
-	 xregexec(pRegex, str, pMatch->grpCount + 1, groups, r)) == 0) {
+		r = (pMatch->flags & SOpt_Fuzzy) ? xregaexec(pRegex, str, &approxMatch, &params, r) :
+		 xregexec(pRegex, str, pMatch->grpCount + 1, groups, r);
+	else
+		r = (pMatch->flags & SOpt_Fuzzy) ? xregauexec(pRegex, &strSource, &approxMatch, &params, r) :
+		 xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
 #else
-	if((r = xregexec(pRegex, str, pMatch->grpCount + 1, groups, r)) == 0) {
+		r = xregexec(pRegex, str, pMatch->grpCount + 1, groups, r);
+	else
+		r = xreguexec(pRegex, &strSource, pMatch->grpCount + 1, groups, r);
 #endif
+	if(r == 0) {
 
 		// A SUCCESSFUL MATCH!  Save groups and returns offsets.  If scan was backward, adjust group 0 offsets first.
 		(void) saveMatch(pMatch, NULL, &regMatch);
 		if(regMatch.direct == Backward) {
+			size_t srcLen = strScan.start - strScan.str0;
 			size_t len = srcLen - groups[0].rm_eo;
 			groups[0].rm_eo = srcLen - groups[0].rm_so;
 			groups[0].rm_so = len;
@@ -1170,7 +1720,7 @@ int regcmp(Datum *pSrc, int scanOffset, Match *pMatch, regmatch_t *result) {
 		// Not found.
 		result->rm_so = -1;
 	else
-		// xreg[a]exec() internal error.
+		// xreg[a][u]exec() internal error.
 		(void) regError(pMatch->pat, r);
 
 	return sess.rtn.status;
@@ -301,6 +301,23 @@ int typahead(int *pCount) {
 	return sess.rtn.status;
 	}
 
+// Wait up to given number of milliseconds for a keystroke or for input on file descriptor fd (if not -1), whichever comes
+// first.  Return true if a keystroke is ready to be read by tgetc(), otherwise false.  Only the terminal file descriptor is
+// checked (with select()), so that ncurses does not refresh the screen or split an escape sequence.  The caller checks for
+// pending keys (via typahead()) beforehand.
+bool tready(int fd, int timeout) {
+	fd_set fds;
+	struct timeval t;
+
+	FD_ZERO(&fds);
+	FD_SET(0, &fds);
+	if(fd >= 0)
+		FD_SET(fd, &fds);
+	t.tv_sec = timeout / 1000;
+	t.tv_usec = timeout % 1000 * 1000;
+	return select((fd > 0 ? fd : 0) + 1, &fds, NULL, NULL, &t) > 0 && FD_ISSET(0, &fds);
+	}
+
 // Update terminal size parameters, given number of columns and rows.
 void setTermSize(ushort cols, ushort rows) {
 
@@ -1167,8 +1184,20 @@ DupErr:
 						// contents of scratch buffer and current buffer and delete the scratch.
 						if((flags & PipeWrite) && (n == INT_MIN || n == 1)) {
 							Line *pLine = pBuf->pFirstLine;
+							LinePool linePool = pBuf->linePool;
+							LineIndex lineIdx = pBuf->lineIdx;
+							long lineTotal = pBuf->lineTotal;
+							long byteTotal = pBuf->byteTotal;
 							pBuf->pFirstLine = sess.cur.pBuf->pFirstLine;
 							sess.cur.pBuf->pFirstLine = pLine;
+							pBuf->linePool = sess.cur.pBuf->linePool;
+							sess.cur.pBuf->linePool = linePool;
+							pBuf->lineIdx = sess.cur.pBuf->lineIdx;
+							sess.cur.pBuf->lineIdx = lineIdx;
+							pBuf->lineTotal = sess.cur.pBuf->lineTotal;
+							sess.cur.pBuf->lineTotal = lineTotal;
+							pBuf->byteTotal = sess.cur.pBuf->byteTotal;
+							sess.cur.pBuf->byteTotal = byteTotal;
 							(void) bdelete(pBuf, BC_IgnChgd);		// Can't fail.
 							pBuf = sess.cur.pBuf;
 							pBuf->flags &= ~BFChanged;
@@ -265,6 +265,9 @@ int getSysVar(Datum *pRtnVal, SysVar *pSysVar) {
 		case sv_bufLineNum:
 			dsetint(getLineNum(sess.cur.pBuf, sess.cur.pFace->point.pLine), pRtnVal);
 			break;
+		case sv_bufMemLimit:
+			dsetint(sess.bufMemLimit, pRtnVal);
+			break;
 		case sv_bufname:
 			str = sess.cur.pBuf->bufname;
 			goto Kopy;
@@ -476,8 +479,9 @@ BadTyp2:
 						}
 					if((n = (pDatum->u.intNum > INT_MAX ? INT_MAX : pDatum->u.intNum)) == 0) {
 
-						// ASave count set to zero... turn off global mode and clear counter.
+						// ASave count set to zero... turn off global modes and clear counter.
 						clearGlobalMode(modeInfo.cache[MdIdxASave]);
+						clearGlobalMode(modeInfo.cache[MdIdxJournal]);
 						sess.autoSaveTrig = sess.autoSaveCount = 0;
 						}
 					else {
@@ -504,6 +508,14 @@ BadTyp2:
 				case sv_bufLineNum:
 					(void) goLine(pSink, INT_MIN, pDatum->u.intNum);
 					break;
+				case sv_bufMemLimit:
+					if(pDatum->u.intNum < 0) {
+						i = 0;
+						goto ERange;
+						}
+					if((sess.bufMemLimit = pDatum->u.intNum) > 0)
+						sess.opFlags |= OpEvict;
+					break;
 				case sv_bufname:
 					str = "renameBuf $bufname, ";
 					goto XeqCmd;
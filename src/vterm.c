@@ -948,7 +948,7 @@ int update(int n) {
 					if(pWind->topRow >= term.rows - 2) {
 
 						// Save the "face" parameters.
-						--pWind->pBuf->windCount;
+						wdetach(pWind);
 						windFaceToBufFace(pWind, pWind->pBuf);
 
 						// Update sess.cur.pWind and lastWind if needed.